@@ -103,6 +103,12 @@ config cfg##_config_instance = config(cfg##_config());
 #define TBLIS_CONFIG_GEMM_ROW_MAJOR(S,D,C,Z) \
     TBLIS_CONFIG_PARAMETER(gemm_row_major, bool, S,D,C,Z, false,false,false,false)
 
+#define TBLIS_CONFIG_GEMM_1M(S,D,C,Z) \
+    TBLIS_CONFIG_PARAMETER(gemm_1m, bool, S,D,C,Z, false,false,false,false)
+
+#define TBLIS_CONFIG_DYNAMIC_PARTITION(S,D,C,Z) \
+    TBLIS_CONFIG_PARAMETER(dynamic_partition, bool, S,D,C,Z, false,false,false,false)
+
 #define TBLIS_CONFIG_M_THREAD_RATIO(S,D,C,Z) \
     TBLIS_CONFIG_PARAMETER(m_thread_ratio, unsigned, S,D,C,Z, 2,2,2,2)
 #define TBLIS_CONFIG_N_THREAD_RATIO(S,D,C,Z) \
@@ -154,6 +160,27 @@ config cfg##_config_instance = config(cfg##_config());
 #define TBLIS_CONFIG_GEMM_UKR(S,D,C,Z) \
     TBLIS_CONFIG_UKR2(this_config, gemm_ukr, gemm_ukr_t, S,D,C,Z, gemm_ukr_def)
 
+/*
+ * Use the given real kernels for complex types as well, via the 1m method
+ * (see gemm_ukr_1m). The complex blocksizes must be set to match.
+ */
+#define TBLIS_CONFIG_GEMM_1M_UKR(S,D) \
+    template <typename T> struct gemm_ukr : static_microkernel<T, \
+        gemm_ukr_t<   float>, S, \
+        gemm_ukr_t<  double>, D, \
+        gemm_ukr_t<scomplex>, gemm_ukr_1m<this_config,scomplex>, \
+        gemm_ukr_t<dcomplex>, gemm_ukr_1m<this_config,dcomplex>> {}; \
+    TBLIS_CONFIG_GEMM_1M(_,_,true,true)
+
+#define TBLIS_CONFIG_UPDATE_NN_UKR(S,D,C,Z) \
+    TBLIS_CONFIG_UKR2(this_config, update_nn_ukr, update_nn_ukr_t, S,D,C,Z, update_nn_ukr_def)
+#define TBLIS_CONFIG_UPDATE_SN_UKR(S,D,C,Z) \
+    TBLIS_CONFIG_UKR2(this_config, update_sn_ukr, update_sn_ukr_t, S,D,C,Z, update_sn_ukr_def)
+#define TBLIS_CONFIG_UPDATE_NS_UKR(S,D,C,Z) \
+    TBLIS_CONFIG_UKR2(this_config, update_ns_ukr, update_ns_ukr_t, S,D,C,Z, update_ns_ukr_def)
+#define TBLIS_CONFIG_UPDATE_SS_UKR(S,D,C,Z) \
+    TBLIS_CONFIG_UKR2(this_config, update_ss_ukr, update_ss_ukr_t, S,D,C,Z, update_ss_ukr_def)
+
 #define TBLIS_CONFIG_PACK_NN_MR_UKR(S,D,C,Z) \
     TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_nn_mr_ukr, pack_nn_ukr_t, S,D,C,Z, pack_nn_ukr_def)
 #define TBLIS_CONFIG_PACK_NN_NR_UKR(S,D,C,Z) \
@@ -181,6 +208,8 @@ config cfg##_config_instance = config(cfg##_config());
 
 #define TBLIS_CONFIG_CHECK(func) static constexpr check_fn_t check = func;
 
+#define TBLIS_CONFIG_L3_CORES(func) static constexpr l3_cores_fn_t l3_cores = func;
+
 namespace tblis
 {
 
@@ -294,6 +323,12 @@ struct config_template
     TBLIS_CONFIG_GEMM_KC(_,_,_,_)
     TBLIS_CONFIG_GEMM_UKR(_,_,_,_)
     TBLIS_CONFIG_GEMM_ROW_MAJOR(_,_,_,_)
+    TBLIS_CONFIG_GEMM_1M(_,_,_,_)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(_,_,_,_)
+    TBLIS_CONFIG_UPDATE_SN_UKR(_,_,_,_)
+    TBLIS_CONFIG_UPDATE_NS_UKR(_,_,_,_)
+    TBLIS_CONFIG_UPDATE_SS_UKR(_,_,_,_)
 
     TBLIS_CONFIG_PACK_NN_MR_UKR(_,_,_,_)
     TBLIS_CONFIG_PACK_NN_NR_UKR(_,_,_,_)
@@ -312,6 +347,9 @@ struct config_template
     TBLIS_CONFIG_N_THREAD_RATIO(_,_,_,_)
     TBLIS_CONFIG_MR_MAX_THREAD(_,_,_,_)
     TBLIS_CONFIG_NR_MAX_THREAD(_,_,_,_)
+    TBLIS_CONFIG_DYNAMIC_PARTITION(_,_,_,_)
+
+    TBLIS_CONFIG_L3_CORES(nullptr)
 };
 
 }
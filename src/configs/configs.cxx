@@ -1,5 +1,11 @@
 #include "configs.hpp"
 #include "configs/include_configs.hpp"
+#include "memory/alignment.hpp"
+#include "util/topology.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
 
 namespace tblis
 {
@@ -20,6 +26,53 @@ const config* const configs[num_configs] =
 #include "configs/foreach_config.h"
 };
 
+void set_cache_blocksize(blocksize& bs, int type, len_type def)
+{
+    len_type over = bs._max[type]-bs._def[type];
+    def = std::max(ceil_div(def, bs._iota[type]), len_type(1))*bs._iota[type];
+
+    bs._def[type] = def;
+    bs._max[type] = def+over;
+    bs._extent[type] = def;
+}
+
+/*
+ * The compiled-in cache blocksizes assume the caches of the processor that
+ * the configuration was tuned for. If the packed block of A (MC*KC) would not
+ * fit in the L2 of this machine, or the packed panel of B (KC*NC) in the L3,
+ * then shrink MC or NC until it does. Blocksizes are never grown.
+ */
+void fit_cache_blocksizes(config& cfg)
+{
+    cfg.revision = next_config_revision();
+
+    auto& topo = get_topology();
+    auto l2 = topo.cache(2);
+    auto l3 = topo.cache(3);
+
+    const len_type type_size[] = {sizeof(float), sizeof(double),
+                                  sizeof(scomplex), sizeof(dcomplex)};
+
+    for (int type = 0;type < 4;type++)
+    {
+        len_type kc = cfg.gemm_kc._def[type]*type_size[type];
+
+        if (l2)
+        {
+            len_type mr = cfg.gemm_mc._iota[type];
+            len_type mc = std::max(l2->size/kc/mr, len_type(1))*mr;
+            if (mc < cfg.gemm_mc._def[type]) set_cache_blocksize(cfg.gemm_mc, type, mc);
+        }
+
+        if (l3)
+        {
+            len_type nr = cfg.gemm_nc._iota[type];
+            len_type nc = std::max(l3->size/kc/nr, len_type(1))*nr;
+            if (nc < cfg.gemm_nc._def[type]) set_cache_blocksize(cfg.gemm_nc, type, nc);
+        }
+    }
+}
+
 struct default_config
 {
     const config* value = nullptr;
@@ -42,6 +95,13 @@ struct default_config
         if (!value)
             tblis_abort_with_message(nullptr,
                 "tblis: No usable configuration enabled, aborting!");
+
+        for (int cfg = 0;cfg < num_configs;cfg++)
+            if (configs[cfg]->check() >= 0)
+                fit_cache_blocksizes(const_cast<config&>(*configs[cfg]));
+
+        const char* file = getenv("TBLIS_BLOCKSIZE_FILE");
+        if (file) load_gemm_cache_blocksizes(file);
     }
 };
 
@@ -58,4 +118,85 @@ const config& get_config(const tblis_config* cfg)
     return (cfg ? *reinterpret_cast<const config*>(cfg) : get_default_config());
 }
 
+std::vector<const config*> get_usable_configs()
+{
+    /*
+     * Make sure that the blocksizes have been adjusted.
+     */
+    get_default_config();
+
+    std::vector<const config*> usable;
+
+    for (int cfg = 0;cfg < num_configs;cfg++)
+        if (configs[cfg]->check() >= 0) usable.push_back(configs[cfg]);
+
+    return usable;
+}
+
+const config* find_config(const std::string& name)
+{
+    get_default_config();
+
+    for (int cfg = 0;cfg < num_configs;cfg++)
+        if (name == configs[cfg]->name && configs[cfg]->check() >= 0)
+            return configs[cfg];
+
+    return nullptr;
+}
+
+unsigned long next_config_revision()
+{
+    static std::atomic<unsigned long> revision(0);
+    return ++revision;
+}
+
+bool set_gemm_cache_blocksizes(const std::string& cfg_name, type_t type,
+                               len_type mc, len_type nc, len_type kc)
+{
+    for (int i = 0;i < num_configs;i++)
+    {
+        if (cfg_name != configs[i]->name) continue;
+
+        /*
+         * The configuration instances themselves are not const.
+         */
+        config& cfg = const_cast<config&>(*configs[i]);
+        cfg.revision = next_config_revision();
+        set_cache_blocksize(cfg.gemm_mc, type, mc);
+        set_cache_blocksize(cfg.gemm_nc, type, nc);
+        set_cache_blocksize(cfg.gemm_kc, type, kc);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool load_gemm_cache_blocksizes(const std::string& file)
+{
+    std::ifstream ifs(file);
+    if (!ifs) return false;
+
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+
+        std::string name;
+        if (!(iss >> name) || name[0] == '#') continue;
+
+        char type;
+        len_type mc, nc, kc;
+        if (!(iss >> type >> mc >> nc >> kc)) continue;
+
+        const char* types = "sdcz";
+        const char* type_pos = strchr(types, type);
+        if (!type_pos || !*type_pos || mc <= 0 || nc <= 0 || kc <= 0) continue;
+
+        set_gemm_cache_blocksizes(name, type_t(type_pos-types), mc, nc, kc);
+    }
+
+    return true;
+}
+
 }
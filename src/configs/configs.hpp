@@ -24,6 +24,12 @@ namespace tblis
 //
 using check_fn_t = int (*)(void);
 
+//
+// Return the number of cores (not logical processors) which share a
+// last-level cache, or 0 if it is shared by all cores
+//
+using l3_cores_fn_t = int (*)(void);
+
 template <typename T> struct type_idx;
 
 template <> struct type_idx<   float> { constexpr static int value = 0; };
@@ -86,6 +92,11 @@ struct parameter
     }
 };
 
+/*
+ * Return a new configuration revision (see config::revision).
+ */
+unsigned long next_config_revision();
+
 struct config
 {
     /*
@@ -125,6 +136,12 @@ struct config
     microkernel<gemm_ukr_t> gemm_ukr;
 
     parameter<bool> gemm_row_major;
+    parameter<bool> gemm_1m;
+
+    microkernel<update_nn_ukr_t> update_nn_ukr;
+    microkernel<update_sn_ukr_t> update_sn_ukr;
+    microkernel<update_ns_ukr_t> update_ns_ukr;
+    microkernel<update_ss_ukr_t> update_ss_ukr;
 
     microkernel<pack_nn_ukr_t> pack_nn_mr_ukr;
     microkernel<pack_nn_ukr_t> pack_nn_nr_ukr;
@@ -144,9 +161,22 @@ struct config
     parameter<unsigned> mr_max_thread;
     parameter<unsigned> nr_max_thread;
 
+    /*
+     * Whether to hand out cache blocks dynamically (see partition).
+     */
+    parameter<bool> dynamic_partition;
+
     check_fn_t check;
+    l3_cores_fn_t l3_cores;
     const char* name;
 
+    /*
+     * Unique to this configuration, and changed whenever it is modified, so
+     * that anything derived from it (e.g. by a plan) can tell whether it is
+     * still valid.
+     */
+    unsigned long revision;
+
     template <typename Traits> config(const Traits&)
     : add_ukr(typename Traits::template add_ukr<float>()),
       copy_ukr(typename Traits::template copy_ukr<float>()),
@@ -173,6 +203,12 @@ struct config
       gemm_ukr(typename Traits::template gemm_ukr<float>()),
 
       gemm_row_major(typename Traits::template gemm_row_major<float>()),
+      gemm_1m(typename Traits::template gemm_1m<float>()),
+
+      update_nn_ukr(typename Traits::template update_nn_ukr<float>()),
+      update_sn_ukr(typename Traits::template update_sn_ukr<float>()),
+      update_ns_ukr(typename Traits::template update_ns_ukr<float>()),
+      update_ss_ukr(typename Traits::template update_ss_ukr<float>()),
 
       pack_nn_mr_ukr(typename Traits::template pack_nn_mr_ukr<float>()),
       pack_nn_nr_ukr(typename Traits::template pack_nn_nr_ukr<float>()),
@@ -191,14 +227,52 @@ struct config
       n_thread_ratio(typename Traits::template n_thread_ratio<float>()),
       mr_max_thread(typename Traits::template mr_max_thread<float>()),
       nr_max_thread(typename Traits::template nr_max_thread<float>()),
+      dynamic_partition(typename Traits::template dynamic_partition<float>()),
 
-      check(Traits::check), name(Traits::name) {}
+      check(Traits::check), l3_cores(Traits::l3_cores), name(Traits::name),
+      revision(next_config_revision()) {}
 };
 
 const config& get_default_config();
 
 const config& get_config(const tblis_config* cfg);
 
+/*
+ * Return all of the configurations which can run on this hardware.
+ */
+std::vector<const config*> get_usable_configs();
+
+/*
+ * Return the configuration with the given name, or nullptr if there is no
+ * such configuration or it cannot run on this hardware.
+ */
+const config* find_config(const std::string& name);
+
+/*
+ * Override the gemm cache blocksizes of the named configuration for one data
+ * type. Each blocksize is rounded up to a multiple of the corresponding
+ * register blocksize, and the maximum blocksize keeps the same margin over
+ * the default as before. This must not be called while the configuration is
+ * in use. Returns false if there is no such configuration.
+ */
+bool set_gemm_cache_blocksizes(const std::string& cfg_name, type_t type,
+                               len_type mc, len_type nc, len_type kc);
+
+/*
+ * Read gemm cache blocksize overrides from a file, in which each line has the
+ * form:
+ *
+ *     <config> <type> <mc> <nc> <kc>
+ *
+ * where type is one of s, d, c, or z. Blank lines and lines starting with #
+ * are ignored. Overrides are read automatically from the file given by
+ * TBLIS_BLOCKSIZE_FILE (if any) before the default configuration is first
+ * used, after the compiled-in blocksizes have been shrunk (if necessary) to
+ * fit the caches of this machine. The file may be generated with
+ * bin/tune_blocksizes. Returns false if the file could not be read.
+ */
+bool load_gemm_cache_blocksizes(const std::string& file);
+
 }
 
 #endif
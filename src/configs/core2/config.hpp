@@ -18,17 +18,16 @@ extern int core2_check();
 
 TBLIS_BEGIN_CONFIG(core2)
 
-TBLIS_CONFIG_GEMM_MR(   8,    4, _, _)
-TBLIS_CONFIG_GEMM_NR(   4,    4, _, _)
-TBLIS_CONFIG_GEMM_KR(   4,    2, _, _)
-TBLIS_CONFIG_GEMM_MC( 768,  384, _, _)
-TBLIS_CONFIG_GEMM_NC(4096, 4096, _, _)
-TBLIS_CONFIG_GEMM_KC( 384,  384, _, _)
-
-TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_8x4,
-                      bli_dgemm_asm_4x4,
-                                      _,
-                                      _)
+TBLIS_CONFIG_GEMM_MR_EXTENT(   8,    4,    4,    2,
+                               8,    4,    8,    4)
+TBLIS_CONFIG_GEMM_NR       (   4,    4,    4,    4)
+TBLIS_CONFIG_GEMM_KR       (   4,    2,    2,    1)
+TBLIS_CONFIG_GEMM_MC       ( 768,  384,  384,  192)
+TBLIS_CONFIG_GEMM_NC       (4096, 4096, 4096, 4096)
+TBLIS_CONFIG_GEMM_KC       ( 384,  384,  192,  192)
+
+TBLIS_CONFIG_GEMM_1M_UKR(bli_sgemm_asm_8x4,
+                         bli_dgemm_asm_4x4)
 
 TBLIS_CONFIG_CHECK(core2_check)
 
@@ -0,0 +1,271 @@
+#include "blis.h"
+
+#include <immintrin.h>
+
+/*
+ * Native complex micro-kernels for the haswell configurations.
+ *
+ * Each kernel computes a 3 x (2*NV) block of C (in units of complex numbers),
+ * where one operand (the "broadcast" operand, S) supplies 3 complex numbers
+ * per k and the other (the "vector" operand, V) supplies 2*NV complex numbers
+ * stored interleaved in NV ymm registers. The real and imaginary parts of S
+ * are broadcast separately and accumulated into two sets of registers:
+ *
+ *   ab_r += real(s) * v = [real(s)*real(v), real(s)*imag(v)]
+ *   ab_i += imag(s) * v = [imag(s)*real(v), imag(s)*imag(v)]
+ *
+ * so that the k loop consists only of FMAs. At the end, s*v is recovered as
+ * addsub(ab_r, swap(ab_i)).
+ *
+ * The row-major kernels (3x8, 3x4) broadcast A and vectorize over B, and the
+ * column-major kernels (8x3, 4x3) broadcast B and vectorize over A. Since
+ * complex multiplication commutes, both use the same code with the roles of
+ * the strides of C exchanged.
+ */
+
+/*
+ * x = alpha*x for complex alpha = (alpha_r, alpha_i).
+ */
+static inline __m256d zscal(__m256d alpha_r, __m256d alpha_i, __m256d x)
+{
+    return _mm256_addsub_pd(_mm256_mul_pd(alpha_r, x),
+                            _mm256_mul_pd(alpha_i, _mm256_permute_pd(x, 0x5)));
+}
+
+static inline __m256 cscal(__m256 alpha_r, __m256 alpha_i, __m256 x)
+{
+    return _mm256_addsub_ps(_mm256_mul_ps(alpha_r, x),
+                            _mm256_mul_ps(alpha_i, _mm256_permute_ps(x, 0xb1)));
+}
+
+/*
+ * Load or store 2 (4) complex numbers of C separated by inc.
+ */
+static inline __m256d zload(const double* c, inc_t inc)
+{
+    if (inc == 1) return _mm256_loadu_pd(c);
+
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(c)),
+                                _mm_loadu_pd(c + 2*inc), 1);
+}
+
+static inline void zstore(double* c, inc_t inc, __m256d x)
+{
+    if (inc == 1)
+    {
+        _mm256_storeu_pd(c, x);
+        return;
+    }
+
+    _mm_storeu_pd(c, _mm256_castpd256_pd128(x));
+    _mm_storeu_pd(c + 2*inc, _mm256_extractf128_pd(x, 1));
+}
+
+static inline __m256 cload(const float* c, inc_t inc)
+{
+    if (inc == 1) return _mm256_loadu_ps(c);
+
+    __m128d lo = _mm_loadh_pd(_mm_load_sd((const double*)c),
+                              (const double*)(c + 2*inc));
+    __m128d hi = _mm_loadh_pd(_mm_load_sd((const double*)(c + 4*inc)),
+                              (const double*)(c + 6*inc));
+
+    return _mm256_castpd_ps(_mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1));
+}
+
+static inline void cstore(float* c, inc_t inc, __m256 x)
+{
+    if (inc == 1)
+    {
+        _mm256_storeu_ps(c, x);
+        return;
+    }
+
+    __m128d lo = _mm256_castpd256_pd128(_mm256_castps_pd(x));
+    __m128d hi = _mm256_extractf128_pd(_mm256_castps_pd(x), 1);
+
+    _mm_storel_pd((double*)c, lo);
+    _mm_storeh_pd((double*)(c + 2*inc), lo);
+    _mm_storel_pd((double*)(c + 4*inc), hi);
+    _mm_storeh_pd((double*)(c + 6*inc), hi);
+}
+
+/*
+ * The accumulators are kept in named variables rather than arrays, since
+ * otherwise they are spilled to the stack in every iteration.
+ */
+#define GEMM_ZERO(zero) \
+    ab_r00 = ab_r01 = ab_r10 = ab_r11 = ab_r20 = ab_r21 = zero; \
+    ab_i00 = ab_i01 = ab_i10 = ab_i11 = ab_i20 = ab_i21 = zero;
+
+#define GEMM_STEP(i, broadcast, fmadd) \
+    s_r = broadcast(s + 2*i); \
+    s_i = broadcast(s + 2*i + 1); \
+    ab_r##i##0 = fmadd(s_r, v0, ab_r##i##0); \
+    ab_r##i##1 = fmadd(s_r, v1, ab_r##i##1); \
+    ab_i##i##0 = fmadd(s_i, v0, ab_i##i##0); \
+    ab_i##i##1 = fmadd(s_i, v1, ab_i##i##1);
+
+/*
+ * C[s][v] = alpha*sum_k S[k][s]*V[k][v] + beta*C[s][v], where C[s][v] is at
+ * c + s*inc_s + v*inc_v (in complex elements).
+ */
+static inline void zgemm_3x4(dim_t k, const double* alpha,
+                             const double* s, const double* v,
+                             const double* beta,
+                             double* c, inc_t inc_s, inc_t inc_v)
+{
+    __m256d ab_r00, ab_r01, ab_r10, ab_r11, ab_r20, ab_r21;
+    __m256d ab_i00, ab_i01, ab_i10, ab_i11, ab_i20, ab_i21;
+    __m256d v0, v1, s_r, s_i;
+
+    GEMM_ZERO(_mm256_setzero_pd())
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        v0 = _mm256_loadu_pd(v);
+        v1 = _mm256_loadu_pd(v + 4);
+
+        GEMM_STEP(0, _mm256_broadcast_sd, _mm256_fmadd_pd)
+        GEMM_STEP(1, _mm256_broadcast_sd, _mm256_fmadd_pd)
+        GEMM_STEP(2, _mm256_broadcast_sd, _mm256_fmadd_pd)
+
+        s += 6;
+        v += 8;
+    }
+
+    __m256d alpha_r = _mm256_broadcast_sd(alpha);
+    __m256d alpha_i = _mm256_broadcast_sd(alpha + 1);
+    __m256d beta_r = _mm256_broadcast_sd(beta);
+    __m256d beta_i = _mm256_broadcast_sd(beta + 1);
+    int beta_zero = beta[0] == 0.0 && beta[1] == 0.0;
+
+    #define ZGEMM_UPDATE(i, j) \
+    { \
+        __m256d ab = _mm256_addsub_pd(ab_r##i##j, \
+                                      _mm256_permute_pd(ab_i##i##j, 0x5)); \
+        ab = zscal(alpha_r, alpha_i, ab); \
+        double* cij = c + 2*(i*inc_s + 2*j*inc_v); \
+        if (!beta_zero) \
+            ab = _mm256_add_pd(ab, zscal(beta_r, beta_i, zload(cij, inc_v))); \
+        zstore(cij, inc_v, ab); \
+    }
+
+    ZGEMM_UPDATE(0, 0) ZGEMM_UPDATE(0, 1)
+    ZGEMM_UPDATE(1, 0) ZGEMM_UPDATE(1, 1)
+    ZGEMM_UPDATE(2, 0) ZGEMM_UPDATE(2, 1)
+
+    #undef ZGEMM_UPDATE
+}
+
+static inline void cgemm_3x8(dim_t k, const float* alpha,
+                             const float* s, const float* v,
+                             const float* beta,
+                             float* c, inc_t inc_s, inc_t inc_v)
+{
+    __m256 ab_r00, ab_r01, ab_r10, ab_r11, ab_r20, ab_r21;
+    __m256 ab_i00, ab_i01, ab_i10, ab_i11, ab_i20, ab_i21;
+    __m256 v0, v1, s_r, s_i;
+
+    GEMM_ZERO(_mm256_setzero_ps())
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        v0 = _mm256_loadu_ps(v);
+        v1 = _mm256_loadu_ps(v + 8);
+
+        GEMM_STEP(0, _mm256_broadcast_ss, _mm256_fmadd_ps)
+        GEMM_STEP(1, _mm256_broadcast_ss, _mm256_fmadd_ps)
+        GEMM_STEP(2, _mm256_broadcast_ss, _mm256_fmadd_ps)
+
+        s += 6;
+        v += 16;
+    }
+
+    __m256 alpha_r = _mm256_broadcast_ss(alpha);
+    __m256 alpha_i = _mm256_broadcast_ss(alpha + 1);
+    __m256 beta_r = _mm256_broadcast_ss(beta);
+    __m256 beta_i = _mm256_broadcast_ss(beta + 1);
+    int beta_zero = beta[0] == 0.0f && beta[1] == 0.0f;
+
+    #define CGEMM_UPDATE(i, j) \
+    { \
+        __m256 ab = _mm256_addsub_ps(ab_r##i##j, \
+                                     _mm256_permute_ps(ab_i##i##j, 0xb1)); \
+        ab = cscal(alpha_r, alpha_i, ab); \
+        float* cij = c + 2*(i*inc_s + 4*j*inc_v); \
+        if (!beta_zero) \
+            ab = _mm256_add_ps(ab, cscal(beta_r, beta_i, cload(cij, inc_v))); \
+        cstore(cij, inc_v, ab); \
+    }
+
+    CGEMM_UPDATE(0, 0) CGEMM_UPDATE(0, 1)
+    CGEMM_UPDATE(1, 0) CGEMM_UPDATE(1, 1)
+    CGEMM_UPDATE(2, 0) CGEMM_UPDATE(2, 1)
+
+    #undef CGEMM_UPDATE
+}
+
+void bli_cgemm_opt_3x8
+     (
+       dim_t               k,
+       scomplex*  restrict alpha,
+       scomplex*  restrict a,
+       scomplex*  restrict b,
+       scomplex*  restrict beta,
+       scomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    cgemm_3x8(k, (const float*)alpha, (const float*)a, (const float*)b,
+              (const float*)beta, (float*)c, rs_c, cs_c);
+}
+
+void bli_cgemm_opt_8x3
+     (
+       dim_t               k,
+       scomplex*  restrict alpha,
+       scomplex*  restrict a,
+       scomplex*  restrict b,
+       scomplex*  restrict beta,
+       scomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    cgemm_3x8(k, (const float*)alpha, (const float*)b, (const float*)a,
+              (const float*)beta, (float*)c, cs_c, rs_c);
+}
+
+void bli_zgemm_opt_3x4
+     (
+       dim_t               k,
+       dcomplex*  restrict alpha,
+       dcomplex*  restrict a,
+       dcomplex*  restrict b,
+       dcomplex*  restrict beta,
+       dcomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    zgemm_3x4(k, (const double*)alpha, (const double*)a, (const double*)b,
+              (const double*)beta, (double*)c, rs_c, cs_c);
+}
+
+void bli_zgemm_opt_4x3
+     (
+       dim_t               k,
+       dcomplex*  restrict alpha,
+       dcomplex*  restrict a,
+       dcomplex*  restrict b,
+       dcomplex*  restrict beta,
+       dcomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    zgemm_3x4(k, (const double*)alpha, (const double*)b, (const double*)a,
+              (const double*)beta, (double*)c, cs_c, rs_c);
+}
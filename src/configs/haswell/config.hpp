@@ -2,6 +2,7 @@
 #define _TBLIS_CONFIGS_HASWELL_CONFIG_HPP_
 
 #include "configs/config_builder.hpp"
+#include "configs/haswell/pack_avx2.hpp"
 
 extern "C"
 {
@@ -16,26 +17,48 @@ EXTERN_GEMM_UKR(double, bli_dgemm_asm_8x6);
 EXTERN_GEMM_UKR(double, bli_dgemm_asm_6x8);
 EXTERN_GEMM_UKR(double, bli_dgemm_asm_4x12);
 
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_8x3);
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_3x8);
+
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_4x3);
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_3x4);
+
 }
 
 namespace tblis
 {
 
+EXTERN_UPDATE_NN_UKR( float, haswell_supdate_nn);
+EXTERN_UPDATE_SN_UKR( float, haswell_supdate_sn);
+EXTERN_UPDATE_NS_UKR( float, haswell_supdate_ns);
+EXTERN_UPDATE_SS_UKR( float, haswell_supdate_ss);
+
+EXTERN_UPDATE_NN_UKR(double, haswell_dupdate_nn);
+EXTERN_UPDATE_SN_UKR(double, haswell_dupdate_sn);
+EXTERN_UPDATE_NS_UKR(double, haswell_dupdate_ns);
+EXTERN_UPDATE_SS_UKR(double, haswell_dupdate_ss);
+
 extern int haswell_check();
 
 TBLIS_BEGIN_CONFIG(haswell_d12x4)
 
-    TBLIS_CONFIG_GEMM_MR(  24,   12, _, _)
-    TBLIS_CONFIG_GEMM_NR(   4,    4, _, _)
-    TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
-    TBLIS_CONFIG_GEMM_MC( 264,   96, _, _)
-    TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
-    TBLIS_CONFIG_GEMM_KC( 128,  192, _, _)
+    TBLIS_CONFIG_GEMM_MR_EXTENT(  24,   12,   12,    6,
+                                  24,   12,   24,   12)
+    TBLIS_CONFIG_GEMM_NR       (   4,    4,    4,    4)
+    TBLIS_CONFIG_GEMM_KR       (   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC       ( 264,   96,  132,   48)
+    TBLIS_CONFIG_GEMM_NC       (4080, 4080, 4080, 4080)
+    TBLIS_CONFIG_GEMM_KC       ( 128,  192,   64,   96)
+
+    TBLIS_CONFIG_GEMM_1M_UKR(bli_sgemm_asm_24x4,
+                             bli_dgemm_asm_12x4)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
 
-    TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_24x4,
-                          bli_dgemm_asm_12x4,
-                          _,
-                          _)
+    TBLIS_CONFIG_HASWELL_PACK_UKR
 
     TBLIS_CONFIG_CHECK(haswell_check)
 
@@ -43,19 +66,25 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d4x12)
 
-    TBLIS_CONFIG_GEMM_MR(   4,    4, _, _)
-    TBLIS_CONFIG_GEMM_NR(  24,   12, _, _)
-    TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
-    TBLIS_CONFIG_GEMM_MC( 264,   96, _, _)
-    TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
-    TBLIS_CONFIG_GEMM_KC( 128,  192, _, _)
+    TBLIS_CONFIG_GEMM_MR       (   4,    4,    4,    4)
+    TBLIS_CONFIG_GEMM_NR_EXTENT(  24,   12,   12,    6,
+                                  24,   12,   24,   12)
+    TBLIS_CONFIG_GEMM_KR       (   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC       ( 264,   96,  264,   96)
+    TBLIS_CONFIG_GEMM_NC       (4080, 4080, 2040, 2040)
+    TBLIS_CONFIG_GEMM_KC       ( 128,  192,   64,   96)
 
-    TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_4x24,
-                          bli_dgemm_asm_4x12,
-                          _,
-                          _)
+    TBLIS_CONFIG_GEMM_1M_UKR(bli_sgemm_asm_4x24,
+                             bli_dgemm_asm_4x12)
 
-    TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, _, _)
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_HASWELL_PACK_UKR
+
+    TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, true, true)
 
     TBLIS_CONFIG_CHECK(haswell_check)
 
@@ -63,17 +92,24 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d8x6)
 
-    TBLIS_CONFIG_GEMM_MR(  16,    8, _, _)
-    TBLIS_CONFIG_GEMM_NR(   6,    6, _, _)
-    TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
-    TBLIS_CONFIG_GEMM_MC( 144,   72, _, _)
-    TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
-    TBLIS_CONFIG_GEMM_KC( 256,  256, _, _)
+    TBLIS_CONFIG_GEMM_MR(  16,    8,    8,    4)
+    TBLIS_CONFIG_GEMM_NR(   6,    6,    3,    3)
+    TBLIS_CONFIG_GEMM_KR(   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC( 144,   72,  144,   72)
+    TBLIS_CONFIG_GEMM_NC(4080, 4080, 2040, 2040)
+    TBLIS_CONFIG_GEMM_KC( 256,  256,  128,  128)
 
     TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_16x6,
                           bli_dgemm_asm_8x6,
-                          _,
-                          _)
+                          bli_cgemm_opt_8x3,
+                          bli_zgemm_opt_4x3)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_HASWELL_PACK_UKR
 
     TBLIS_CONFIG_CHECK(haswell_check)
 
@@ -81,19 +117,26 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d6x8)
 
-    TBLIS_CONFIG_GEMM_MR(   6,    6, _, _)
-    TBLIS_CONFIG_GEMM_NR(  16,    8, _, _)
-    TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
-    TBLIS_CONFIG_GEMM_MC( 144,   72, _, _)
-    TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
-    TBLIS_CONFIG_GEMM_KC( 256,  256, _, _)
+    TBLIS_CONFIG_GEMM_MR(   6,    6,    3,    3)
+    TBLIS_CONFIG_GEMM_NR(  16,    8,    8,    4)
+    TBLIS_CONFIG_GEMM_KR(   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC( 144,   72,  144,   72)
+    TBLIS_CONFIG_GEMM_NC(4080, 4080, 2040, 2040)
+    TBLIS_CONFIG_GEMM_KC( 256,  256,  128,  128)
 
     TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_6x16,
                           bli_dgemm_asm_6x8,
-                          _,
-                          _)
+                          bli_cgemm_opt_3x8,
+                          bli_zgemm_opt_3x4)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_HASWELL_PACK_UKR
 
-    TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, _, _)
+    TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, true, true)
 
     TBLIS_CONFIG_CHECK(haswell_check)
 
@@ -0,0 +1,458 @@
+#ifndef _TBLIS_CONFIGS_HASWELL_PACK_AVX2_HPP_
+#define _TBLIS_CONFIGS_HASWELL_PACK_AVX2_HPP_
+
+/*
+ * AVX2 packing kernels for all of the scatter variants (complex types are
+ * packed with scalar code). These are templates on the configuration like the
+ * default kernels, so the definitions are only visible (and the kernels may
+ * only be instantiated) in translation units compiled for AVX2.
+ * TBLIS_CONFIG_HASWELL_PACK_UKR registers all of them in a configuration, and
+ * TBLIS_CONFIG_HASWELL_PACK_SCATTER_UKR all but pack_nn.
+ */
+
+#include "configs/config_builder.hpp"
+
+namespace tblis
+{
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_nn(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, stride_type cs_a,
+                     T* p_ap);
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_sn(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a, stride_type cs_a,
+                     T* p_ap);
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_ns(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, const stride_type* cscat_a,
+                     T* p_ap);
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_ss(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a,
+                     const stride_type* cscat_a, T* p_ap);
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_nb(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, const stride_type* cscat_a,
+                     const stride_type* cbs_a, T* p_ap);
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_sb(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a,
+                     const stride_type* cscat_a, const stride_type* cbs_a,
+                     T* p_ap);
+
+}
+
+#define TBLIS_CONFIG_HASWELL_PACK_UKR \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_nn_mr_ukr, pack_nn_ukr_t, _,_,_,_, haswell_pack_nn) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_nn_nr_ukr, pack_nn_ukr_t, _,_,_,_, haswell_pack_nn) \
+    TBLIS_CONFIG_HASWELL_PACK_SCATTER_UKR
+
+#define TBLIS_CONFIG_HASWELL_PACK_SCATTER_UKR \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_sn_mr_ukr, pack_sn_ukr_t, _,_,_,_, haswell_pack_sn) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_sn_nr_ukr, pack_sn_ukr_t, _,_,_,_, haswell_pack_sn) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_ns_mr_ukr, pack_ns_ukr_t, _,_,_,_, haswell_pack_ns) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_ns_nr_ukr, pack_ns_ukr_t, _,_,_,_, haswell_pack_ns) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_ss_mr_ukr, pack_ss_ukr_t, _,_,_,_, haswell_pack_ss) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_ss_nr_ukr, pack_ss_ukr_t, _,_,_,_, haswell_pack_ss) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_nb_mr_ukr, pack_nb_ukr_t, _,_,_,_, haswell_pack_nb) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_nb_nr_ukr, pack_nb_ukr_t, _,_,_,_, haswell_pack_nb) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_sb_mr_ukr, pack_sb_ukr_t, _,_,_,_, haswell_pack_sb) \
+    TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_sb_nr_ukr, pack_sb_ukr_t, _,_,_,_, haswell_pack_sb)
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+namespace tblis
+{
+
+namespace haswell_pack
+{
+
+static_assert(sizeof(stride_type) == 8,
+              "The gathered packing loads the scatter offsets as 64-bit integers");
+
+/*
+ * Number of columns ahead of the current one for which the source data is
+ * prefetched when the columns are scattered.
+ */
+constexpr len_type PREFETCH_DIST = 4;
+
+inline __m256i mask_epi64(len_type n)
+{
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n),
+                              _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+/*
+ * Vectors of four elements, so that one vector of 64-bit offsets can gather
+ * a whole vector.
+ */
+template <typename T> struct vec4 { static constexpr bool value = false; };
+
+template <> struct vec4<double>
+{
+    static constexpr bool value = true;
+
+    typedef __m256d type;
+
+    static type zero() { return _mm256_setzero_pd(); }
+
+    static type load(const double* p) { return _mm256_loadu_pd(p); }
+
+    static type load(const double* p, __m256i k) { return _mm256_maskload_pd(p, k); }
+
+    static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+
+    static void store(double* p, __m256i k, type v) { _mm256_maskstore_pd(p, k, v); }
+
+    static type gather(const double* p, __m256i off, __m256i k)
+    {
+        return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), p, off,
+                                        _mm256_castsi256_pd(k), 8);
+    }
+
+    static void transpose(type& v0, type& v1, type& v2, type& v3)
+    {
+        __m256d t0 = _mm256_unpacklo_pd(v0, v1);
+        __m256d t1 = _mm256_unpackhi_pd(v0, v1);
+        __m256d t2 = _mm256_unpacklo_pd(v2, v3);
+        __m256d t3 = _mm256_unpackhi_pd(v2, v3);
+        v0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        v1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        v2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        v3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+};
+
+template <> struct vec4<float>
+{
+    static constexpr bool value = true;
+
+    typedef __m128 type;
+
+    static __m128i narrow(__m256i k)
+    {
+        return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(k,
+            _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    }
+
+    static type zero() { return _mm_setzero_ps(); }
+
+    static type load(const float* p) { return _mm_loadu_ps(p); }
+
+    static type load(const float* p, __m256i k) { return _mm_maskload_ps(p, narrow(k)); }
+
+    static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+
+    static void store(float* p, __m256i k, type v) { _mm_maskstore_ps(p, narrow(k), v); }
+
+    static type gather(const float* p, __m256i off, __m256i k)
+    {
+        return _mm256_mask_i64gather_ps(_mm_setzero_ps(), p, off,
+                                        _mm_castsi128_ps(narrow(k)), 4);
+    }
+
+    static void transpose(type& v0, type& v1, type& v2, type& v3)
+    {
+        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    }
+};
+
+/*
+ * The rows of an MR x k (or NR x k) panel. If off is null then the rows have
+ * unit stride, otherwise row i is at offset off[i]. Rows past m are
+ * zero-filled. This is the scalar version for types without a vector
+ * implementation (i.e. complex types).
+ */
+template <typename T, len_type MR, bool Vector = vec4<T>::value>
+struct panel_rows
+{
+    len_type m;
+    const stride_type* off;
+
+    panel_rows(len_type m, const stride_type* off)
+    : m(m), off(off) {}
+
+    void pack_column(const T* p_a, T* p_ap) const
+    {
+        for (len_type mr = 0;mr < m;mr++)
+            p_ap[mr] = p_a[off ? off[mr] : mr];
+
+        for (len_type mr = m;mr < MR;mr++)
+            p_ap[mr] = T();
+    }
+
+    template <len_type ME>
+    void pack_strided(len_type k, const T* p_a, stride_type cs_a, T* p_ap) const
+    {
+        for (len_type p = 0;p < k;p++)
+            pack_column(p_a + p*cs_a, p_ap + ME*p);
+    }
+};
+
+/*
+ * The vector version: the offsets and masks for rows past m are held in
+ * registers for the whole panel.
+ */
+template <typename T, len_type MR>
+struct panel_rows<T, MR, true>
+{
+    typedef vec4<T> V;
+    static constexpr len_type NV = (MR+3)/4;
+
+    len_type m;
+    const stride_type* off;
+    __m256i voff[NV];
+    __m256i vmask[NV];
+
+    panel_rows(len_type m, const stride_type* off)
+    : m(m), off(off)
+    {
+        for (len_type v = 0;v < NV;v++)
+        {
+            vmask[v] = mask_epi64(m-4*v);
+            if (off) voff[v] = _mm256_maskload_epi64((const long long*)(off+4*v), vmask[v]);
+        }
+    }
+
+    /*
+     * Pack one column starting at p_a into p_ap.
+     */
+    void pack_column(const T* TBLIS_RESTRICT p_a, T* TBLIS_RESTRICT p_ap) const
+    {
+        /*
+         * A full column with unit stride is a plain copy, which the compiler
+         * vectorizes with the full vector width.
+         */
+        if (!off && m == MR)
+        {
+            for (len_type mr = 0;mr < MR;mr++) p_ap[mr] = p_a[mr];
+            return;
+        }
+
+        for (len_type v = 0;v < NV;v++)
+        {
+            typename V::type x;
+
+            if (off)
+                x = V::gather(p_a, voff[v], vmask[v]);
+            else
+                x = V::load(p_a + 4*v, vmask[v]);
+
+            if (MR%4 == 0 || v < NV-1)
+                V::store(p_ap + 4*v, x);
+            else
+                V::store(p_ap + 4*v, mask_epi64(MR%4), x);
+        }
+    }
+
+    /*
+     * Pack k columns with constant stride cs_a. When the columns have unit
+     * stride the panel is transposed with respect to the packed layout, and
+     * 4x4 blocks are loaded along the rows and transposed in registers.
+     */
+    template <len_type ME>
+    void pack_strided(len_type k, const T* p_a, stride_type cs_a, T* p_ap) const
+    {
+        len_type p = 0;
+
+        if (off && cs_a == 1)
+        {
+            len_type k4 = k - k%4;
+
+            const T* a[4*NV];
+            for (len_type i = 0;i < 4*NV;i++)
+                a[i] = (i < m ? p_a + off[i] : nullptr);
+
+            for (len_type q = 0;q < k4;q += 4)
+            {
+                for (len_type v = 0;v < NV;v++)
+                {
+                    typename V::type x0 = a[4*v+0] ? V::load(a[4*v+0]+q) : V::zero();
+                    typename V::type x1 = a[4*v+1] ? V::load(a[4*v+1]+q) : V::zero();
+                    typename V::type x2 = a[4*v+2] ? V::load(a[4*v+2]+q) : V::zero();
+                    typename V::type x3 = a[4*v+3] ? V::load(a[4*v+3]+q) : V::zero();
+
+                    V::transpose(x0, x1, x2, x3);
+
+                    T* ap = p_ap + 4*v + ME*q;
+                    if (MR%4 == 0 || v < NV-1)
+                    {
+                        V::store(ap       , x0);
+                        V::store(ap +   ME, x1);
+                        V::store(ap + 2*ME, x2);
+                        V::store(ap + 3*ME, x3);
+                    }
+                    else
+                    {
+                        __m256i k_st = mask_epi64(MR%4);
+                        V::store(ap       , k_st, x0);
+                        V::store(ap +   ME, k_st, x1);
+                        V::store(ap + 2*ME, k_st, x2);
+                        V::store(ap + 3*ME, k_st, x3);
+                    }
+                }
+            }
+
+            p = k4;
+        }
+
+        for (;p < k;p++)
+            pack_column(p_a + p*cs_a, p_ap + ME*p);
+    }
+};
+
+/*
+ * Pack k columns at the offsets in cscat_a. The source data for upcoming
+ * columns, and the next cache line of offsets, are prefetched.
+ */
+template <len_type ME, typename Rows, typename T>
+void pack_scattered(const Rows& rows, len_type k, const T* p_a,
+                    const stride_type* cscat_a, T* p_ap)
+{
+    const stride_type row0 = (rows.off && rows.m > 0 ? rows.off[0] : 0);
+
+    for (len_type p = 0;p < k;p++)
+    {
+        if (p%8 == 0)
+            _mm_prefetch((const char*)(cscat_a + p + 16), _MM_HINT_T0);
+
+        if (p+PREFETCH_DIST < k)
+            _mm_prefetch((const char*)(p_a + row0 + cscat_a[p+PREFETCH_DIST]), _MM_HINT_T0);
+
+        rows.pack_column(p_a + cscat_a[p], p_ap + ME*p);
+    }
+}
+
+/*
+ * Pack k columns given in blocks of KR: each block has a constant stride
+ * cbs_a[b] (starting at the first offset of the block) or, if zero, is
+ * scattered.
+ */
+template <len_type ME, len_type KR, typename Rows, typename T>
+void pack_block_scattered(const Rows& rows, len_type k, const T* p_a,
+                          const stride_type* cscat_a, const stride_type* cbs_a,
+                          T* p_ap)
+{
+    for (len_type p = 0;p < k;p += KR)
+    {
+        len_type k_loc = std::min(KR, k-p);
+
+        if (*cbs_a)
+            rows.template pack_strided<ME>(k_loc, p_a + *cscat_a, *cbs_a, p_ap);
+        else
+            pack_scattered<ME>(rows, k_loc, p_a, cscat_a, p_ap);
+
+        p_ap += ME*KR;
+        cscat_a += KR;
+        cbs_a++;
+    }
+}
+
+template <typename Config, typename T, int Mat>
+struct pack_traits
+{
+    static constexpr len_type MR = (Mat == matrix_constants::MAT_A ?
+                                    Config::template gemm_mr<T>::def :
+                                    Config::template gemm_nr<T>::def);
+    static constexpr len_type ME = (Mat == matrix_constants::MAT_A ?
+                                    Config::template gemm_mr<T>::extent :
+                                    Config::template gemm_nr<T>::extent);
+    static constexpr len_type KR = Config::template gemm_kr<T>::def;
+};
+
+/*
+ * Row offsets for a constant row stride, or null if the rows have unit
+ * stride.
+ */
+template <len_type MR>
+struct strided_rows
+{
+    stride_type off[MR];
+    const stride_type* ptr;
+
+    strided_rows(len_type m, stride_type rs_a)
+    : ptr(rs_a == 1 ? nullptr : off)
+    {
+        for (len_type i = 0;i < m;i++) off[i] = i*rs_a;
+    }
+};
+
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_nn(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, stride_type cs_a,
+                     T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::strided_rows<traits::MR> rows(m, rs_a);
+    haswell_pack::panel_rows<T, traits::MR>(m, rows.ptr)
+        .template pack_strided<traits::ME>(k, p_a, cs_a, p_ap);
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_sn(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a, stride_type cs_a,
+                     T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::panel_rows<T, traits::MR>(m, rscat_a)
+        .template pack_strided<traits::ME>(k, p_a, cs_a, p_ap);
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_ns(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, const stride_type* cscat_a,
+                     T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::strided_rows<traits::MR> rows(m, rs_a);
+    haswell_pack::pack_scattered<traits::ME>(
+        haswell_pack::panel_rows<T, traits::MR>(m, rows.ptr), k, p_a, cscat_a, p_ap);
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_ss(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a,
+                     const stride_type* cscat_a, T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::pack_scattered<traits::ME>(
+        haswell_pack::panel_rows<T, traits::MR>(m, rscat_a), k, p_a, cscat_a, p_ap);
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_nb(len_type m, len_type k,
+                     const T* p_a, stride_type rs_a, const stride_type* cscat_a,
+                     const stride_type* cbs_a, T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::strided_rows<traits::MR> rows(m, rs_a);
+    haswell_pack::pack_block_scattered<traits::ME, traits::KR>(
+        haswell_pack::panel_rows<T, traits::MR>(m, rows.ptr), k, p_a, cscat_a, cbs_a, p_ap);
+}
+
+template <typename Config, typename T, int Mat>
+void haswell_pack_sb(len_type m, len_type k,
+                     const T* p_a, const stride_type* rscat_a,
+                     const stride_type* cscat_a, const stride_type* cbs_a,
+                     T* p_ap)
+{
+    typedef haswell_pack::pack_traits<Config, T, Mat> traits;
+    haswell_pack::pack_block_scattered<traits::ME, traits::KR>(
+        haswell_pack::panel_rows<T, traits::MR>(m, rscat_a), k, p_a, cscat_a, cbs_a, p_ap);
+}
+
+}
+
+#endif
+
+#endif
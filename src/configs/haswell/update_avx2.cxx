@@ -0,0 +1,244 @@
+#include <immintrin.h>
+
+#include "config.hpp"
+
+namespace tblis
+{
+
+namespace
+{
+
+static_assert(sizeof(stride_type) == 8,
+              "The gathered updates load the scatter offsets as 64-bit integers");
+
+inline __m256i mask_epi64(len_type n)
+{
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n),
+                              _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+inline __m256i mask_epi32(len_type n)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+                              _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+/*
+ * Update an m x n block of C from AB, where AB has unit stride along m. If
+ * idx is null then C also has unit stride along m and partial vectors use
+ * masked loads and stores, otherwise C is gathered with the offsets in idx
+ * (AVX2 has no scatter, so stores are scalar).
+ */
+
+void update_block(len_type m, len_type n,
+                  const double* TBLIS_RESTRICT p_ab, stride_type cs_ab, double beta,
+                  double* TBLIS_RESTRICT p_c, const stride_type* TBLIS_RESTRICT idx,
+                  stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    __m256d vbeta = _mm256_set1_pd(beta);
+    __m256i k = mask_epi64(m%4);
+    len_type m4 = m - m%4;
+
+    for (len_type j = 0;j < n;j++)
+    {
+        const double* ab = p_ab + j*cs_ab;
+        double* c = p_c + (cscat_c ? cscat_c[j] : j*cs_c);
+
+        if (!idx)
+        {
+            if (beta == 0.0)
+            {
+                for (len_type i = 0;i < m4;i += 4)
+                    _mm256_storeu_pd(c+i, _mm256_loadu_pd(ab+i));
+                if (m4 < m)
+                    _mm256_maskstore_pd(c+m4, k, _mm256_maskload_pd(ab+m4, k));
+            }
+            else
+            {
+                for (len_type i = 0;i < m4;i += 4)
+                    _mm256_storeu_pd(c+i, _mm256_fmadd_pd(vbeta, _mm256_loadu_pd(c+i),
+                                                                 _mm256_loadu_pd(ab+i)));
+                if (m4 < m)
+                    _mm256_maskstore_pd(c+m4, k,
+                        _mm256_fmadd_pd(vbeta, _mm256_maskload_pd(c+m4, k),
+                                               _mm256_maskload_pd(ab+m4, k)));
+            }
+        }
+        else if (beta == 0.0)
+        {
+            for (len_type i = 0;i < m;i++) c[idx[i]] = ab[i];
+        }
+        else
+        {
+            for (len_type i = 0;i < m;i += 4)
+            {
+                len_type r = std::min<len_type>(4, m-i);
+                __m256i ki = (r == 4 ? _mm256_set1_epi64x(-1) : k);
+                __m256i off = _mm256_maskload_epi64((const long long*)(idx+i), ki);
+                __m256d v = _mm256_fmadd_pd(vbeta,
+                    _mm256_mask_i64gather_pd(_mm256_setzero_pd(), c, off,
+                                             _mm256_castsi256_pd(ki), 8),
+                    _mm256_maskload_pd(ab+i, ki));
+
+                double tmp[4];
+                _mm256_storeu_pd(tmp, v);
+                for (len_type l = 0;l < r;l++) c[idx[i+l]] = tmp[l];
+            }
+        }
+    }
+}
+
+void update_block(len_type m, len_type n,
+                  const float* TBLIS_RESTRICT p_ab, stride_type cs_ab, float beta,
+                  float* TBLIS_RESTRICT p_c, const stride_type* TBLIS_RESTRICT idx,
+                  stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    __m256 vbeta = _mm256_set1_ps(beta);
+    __m256i k = mask_epi32(m%8);
+    len_type m8 = m - m%8;
+
+    /*
+     * Only four 64-bit offsets fit in a register, so gathers use 128-bit
+     * vectors.
+     */
+    __m128 vbeta4 = _mm_set1_ps(beta);
+    __m256i k64 = mask_epi64(m%4);
+    __m128i k32 = _mm256_castsi256_si128(mask_epi32(m%4));
+
+    for (len_type j = 0;j < n;j++)
+    {
+        const float* ab = p_ab + j*cs_ab;
+        float* c = p_c + (cscat_c ? cscat_c[j] : j*cs_c);
+
+        if (!idx)
+        {
+            if (beta == 0.0f)
+            {
+                for (len_type i = 0;i < m8;i += 8)
+                    _mm256_storeu_ps(c+i, _mm256_loadu_ps(ab+i));
+                if (m8 < m)
+                    _mm256_maskstore_ps(c+m8, k, _mm256_maskload_ps(ab+m8, k));
+            }
+            else
+            {
+                for (len_type i = 0;i < m8;i += 8)
+                    _mm256_storeu_ps(c+i, _mm256_fmadd_ps(vbeta, _mm256_loadu_ps(c+i),
+                                                                 _mm256_loadu_ps(ab+i)));
+                if (m8 < m)
+                    _mm256_maskstore_ps(c+m8, k,
+                        _mm256_fmadd_ps(vbeta, _mm256_maskload_ps(c+m8, k),
+                                               _mm256_maskload_ps(ab+m8, k)));
+            }
+        }
+        else if (beta == 0.0f)
+        {
+            for (len_type i = 0;i < m;i++) c[idx[i]] = ab[i];
+        }
+        else
+        {
+            for (len_type i = 0;i < m;i += 4)
+            {
+                len_type r = std::min<len_type>(4, m-i);
+                __m256i ki = (r == 4 ? _mm256_set1_epi64x(-1) : k64);
+                __m128i ki32 = (r == 4 ? _mm_set1_epi32(-1) : k32);
+                __m256i off = _mm256_maskload_epi64((const long long*)(idx+i), ki);
+                __m128 v = _mm_fmadd_ps(vbeta4,
+                    _mm256_mask_i64gather_ps(_mm_setzero_ps(), c, off,
+                                             _mm_castsi128_ps(ki32), 4),
+                    _mm_maskload_ps(ab+i, ki32));
+
+                float tmp[4];
+                _mm_storeu_ps(tmp, v);
+                for (len_type l = 0;l < r;l++) c[idx[i+l]] = tmp[l];
+            }
+        }
+    }
+}
+
+/*
+ * Vectorize along the unit-stride dimension of AB. A null scatter vector
+ * means that the corresponding constant stride is used instead.
+ */
+template <typename T>
+void update(len_type m, len_type n,
+            const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+            T beta, T* TBLIS_RESTRICT p_c,
+            stride_type rs_c, const stride_type* TBLIS_RESTRICT rscat_c,
+            stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    if (rs_ab != 1)
+    {
+        std::swap(m, n);
+        std::swap(rs_ab, cs_ab);
+        std::swap(rs_c, cs_c);
+        std::swap(rscat_c, cscat_c);
+    }
+
+    if (rs_ab != 1)
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                T& c = p_c[(rscat_c ? rscat_c[i] : i*rs_c) +
+                           (cscat_c ? cscat_c[j] : j*cs_c)];
+                c = p_ab[i*rs_ab + j*cs_ab] + (beta == T(0) ? T(0) : beta*c);
+            }
+        }
+
+        return;
+    }
+
+    TBLIS_ASSERT(m <= 512);
+
+    stride_type idx[512];
+
+    if (!rscat_c && rs_c != 1)
+    {
+        for (len_type i = 0;i < m;i++) idx[i] = i*rs_c;
+        rscat_c = idx;
+    }
+
+    update_block(m, n, p_ab, cs_ab, beta, p_c, rscat_c, cs_c, cscat_c);
+}
+
+}
+
+#define UPDATE_KERNELS(T, ch) \
+\
+void haswell_##ch##update_nn(len_type m, len_type n, \
+                             const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                             const T* beta, \
+                             T* p_c, stride_type rs_c, stride_type cs_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, rs_c, nullptr, cs_c, nullptr); \
+} \
+\
+void haswell_##ch##update_sn(len_type m, len_type n, \
+                             const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                             const T* beta, \
+                             T* p_c, const stride_type* rscat_c, stride_type cs_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, 0, rscat_c, cs_c, nullptr); \
+} \
+\
+void haswell_##ch##update_ns(len_type m, len_type n, \
+                             const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                             const T* beta, \
+                             T* p_c, stride_type rs_c, const stride_type* cscat_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, rs_c, nullptr, 0, cscat_c); \
+} \
+\
+void haswell_##ch##update_ss(len_type m, len_type n, \
+                             const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                             const T* beta, \
+                             T* p_c, const stride_type* rscat_c, const stride_type* cscat_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, 0, rscat_c, 0, cscat_c); \
+}
+
+UPDATE_KERNELS( float, s)
+UPDATE_KERNELS(double, d)
+
+}
@@ -0,0 +1,187 @@
+#ifndef _TBLIS_CONFIGS_KNL_BLI_GEMM_AVX512_Z12X4_H_
+#define _TBLIS_CONFIGS_KNL_BLI_GEMM_AVX512_Z12X4_H_
+
+#include "blis.h"
+
+#include <immintrin.h>
+
+/*
+ * AVX-512 complex micro-kernel bodies.
+ *
+ * These follow the haswell complex kernels (see
+ * haswell/bli_gemm_opt_z3x4.c): one operand (S) supplies 12 complex numbers
+ * per k, whose real and imaginary parts are broadcast separately, and the
+ * other (V) supplies one zmm register of interleaved complex numbers, so
+ * that the k loop consists only of FMAs. AVX-512 has no addsub instruction,
+ * so the final combination uses fmaddsub instead.
+ *
+ * Row-major kernels pass A as S, and column-major kernels pass B as S with
+ * the strides of C exchanged. This header is shared by the knl and skx
+ * configurations, each of which defines its own kernel entry points.
+ */
+
+#define REPEAT12(f) f(0) f(1) f(2) f(3) f(4) f(5) f(6) f(7) f(8) f(9) f(10) f(11)
+
+/*
+ * x = alpha*x for complex alpha = (alpha_r, alpha_i).
+ */
+static inline __m512d zscal(__m512d alpha_r, __m512d alpha_i, __m512d x)
+{
+    return _mm512_fmaddsub_pd(alpha_r, x,
+        _mm512_mul_pd(alpha_i, _mm512_permute_pd(x, 0x55)));
+}
+
+static inline __m512 cscal(__m512 alpha_r, __m512 alpha_i, __m512 x)
+{
+    return _mm512_fmaddsub_ps(alpha_r, x,
+        _mm512_mul_ps(alpha_i, _mm512_permute_ps(x, 0xb1)));
+}
+
+/*
+ * Load or store 4 (8) complex numbers of C separated by inc.
+ */
+static inline __m512i zoffsets(inc_t inc)
+{
+    return _mm512_set_epi64(6*inc+1, 6*inc, 4*inc+1, 4*inc,
+                            2*inc+1, 2*inc,        1,     0);
+}
+
+static inline __m512i coffsets(inc_t inc)
+{
+    return _mm512_set_epi64(7*inc, 6*inc, 5*inc, 4*inc,
+                            3*inc, 2*inc,   inc,     0);
+}
+
+static inline __m512d zload(const double* c, inc_t inc)
+{
+    if (inc == 1) return _mm512_loadu_pd(c);
+    return _mm512_i64gather_pd(zoffsets(inc), c, 8);
+}
+
+static inline void zstore(double* c, inc_t inc, __m512d x)
+{
+    if (inc == 1) _mm512_storeu_pd(c, x);
+    else _mm512_i64scatter_pd(c, zoffsets(inc), x, 8);
+}
+
+static inline __m512 cload(const float* c, inc_t inc)
+{
+    if (inc == 1) return _mm512_loadu_ps(c);
+    return _mm512_castpd_ps(_mm512_i64gather_pd(coffsets(inc), c, 8));
+}
+
+static inline void cstore(float* c, inc_t inc, __m512 x)
+{
+    if (inc == 1) _mm512_storeu_ps(c, x);
+    else _mm512_i64scatter_pd(c, coffsets(inc), _mm512_castps_pd(x), 8);
+}
+
+#define GEMM_DECLARE(i) ab_r##i, ab_i##i,
+
+#define GEMM_ZERO(i) ab_r##i = ab_i##i = zero;
+
+#define GEMM_STEP(i) \
+    ab_r##i = fmadd(broadcast(s[2*i  ]), v0, ab_r##i); \
+    ab_i##i = fmadd(broadcast(s[2*i+1]), v0, ab_i##i);
+
+/*
+ * C[s][v] = alpha*sum_k S[k][s]*V[k][v] + beta*C[s][v], where C[s][v] is at
+ * c + s*inc_s + v*inc_v (in complex elements).
+ */
+static inline void zgemm_12x4(dim_t k, const double* alpha,
+                              const double* s, const double* v,
+                              const double* beta,
+                              double* c, inc_t inc_s, inc_t inc_v)
+{
+    #define broadcast _mm512_set1_pd
+    #define fmadd _mm512_fmadd_pd
+
+    __m512d REPEAT12(GEMM_DECLARE) v0, zero = _mm512_setzero_pd();
+
+    REPEAT12(GEMM_ZERO)
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        v0 = _mm512_loadu_pd(v);
+
+        REPEAT12(GEMM_STEP)
+
+        s += 24;
+        v += 8;
+    }
+
+    #undef broadcast
+    #undef fmadd
+
+    __m512d alpha_r = _mm512_set1_pd(alpha[0]);
+    __m512d alpha_i = _mm512_set1_pd(alpha[1]);
+    __m512d beta_r = _mm512_set1_pd(beta[0]);
+    __m512d beta_i = _mm512_set1_pd(beta[1]);
+    __m512d one = _mm512_set1_pd(1.0);
+    int beta_zero = beta[0] == 0.0 && beta[1] == 0.0;
+
+    #define ZGEMM_UPDATE(i) \
+    { \
+        __m512d ab = _mm512_fmaddsub_pd(ab_r##i, one, \
+                                        _mm512_permute_pd(ab_i##i, 0x55)); \
+        ab = zscal(alpha_r, alpha_i, ab); \
+        double* ci = c + 2*i*inc_s; \
+        if (!beta_zero) \
+            ab = _mm512_add_pd(ab, zscal(beta_r, beta_i, zload(ci, inc_v))); \
+        zstore(ci, inc_v, ab); \
+    }
+
+    REPEAT12(ZGEMM_UPDATE)
+
+    #undef ZGEMM_UPDATE
+}
+
+static inline void cgemm_12x8(dim_t k, const float* alpha,
+                              const float* s, const float* v,
+                              const float* beta,
+                              float* c, inc_t inc_s, inc_t inc_v)
+{
+    #define broadcast _mm512_set1_ps
+    #define fmadd _mm512_fmadd_ps
+
+    __m512 REPEAT12(GEMM_DECLARE) v0, zero = _mm512_setzero_ps();
+
+    REPEAT12(GEMM_ZERO)
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        v0 = _mm512_loadu_ps(v);
+
+        REPEAT12(GEMM_STEP)
+
+        s += 24;
+        v += 16;
+    }
+
+    #undef broadcast
+    #undef fmadd
+
+    __m512 alpha_r = _mm512_set1_ps(alpha[0]);
+    __m512 alpha_i = _mm512_set1_ps(alpha[1]);
+    __m512 beta_r = _mm512_set1_ps(beta[0]);
+    __m512 beta_i = _mm512_set1_ps(beta[1]);
+    __m512 one = _mm512_set1_ps(1.0f);
+    int beta_zero = beta[0] == 0.0f && beta[1] == 0.0f;
+
+    #define CGEMM_UPDATE(i) \
+    { \
+        __m512 ab = _mm512_fmaddsub_ps(ab_r##i, one, \
+                                       _mm512_permute_ps(ab_i##i, 0xb1)); \
+        ab = cscal(alpha_r, alpha_i, ab); \
+        float* ci = c + 2*i*inc_s; \
+        if (!beta_zero) \
+            ab = _mm512_add_ps(ab, cscal(beta_r, beta_i, cload(ci, inc_v))); \
+        cstore(ci, inc_v, ab); \
+    }
+
+    REPEAT12(CGEMM_UPDATE)
+
+    #undef CGEMM_UPDATE
+}
+
+#endif
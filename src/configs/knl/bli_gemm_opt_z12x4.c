@@ -0,0 +1,72 @@
+#include "bli_gemm_avx512_z12x4.h"
+
+/*
+ * Native complex micro-kernels for the knl configurations (see
+ * bli_gemm_avx512_z12x4.h). The row-major kernels (12x8, 12x4) broadcast A
+ * and vectorize over B, and the column-major kernels (8x12, 4x12) broadcast
+ * B and vectorize over A.
+ */
+
+void bli_cgemm_opt_12x8
+     (
+       dim_t               k,
+       scomplex*  restrict alpha,
+       scomplex*  restrict a,
+       scomplex*  restrict b,
+       scomplex*  restrict beta,
+       scomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    cgemm_12x8(k, (const float*)alpha, (const float*)a, (const float*)b,
+               (const float*)beta, (float*)c, rs_c, cs_c);
+}
+
+void bli_cgemm_opt_8x12
+     (
+       dim_t               k,
+       scomplex*  restrict alpha,
+       scomplex*  restrict a,
+       scomplex*  restrict b,
+       scomplex*  restrict beta,
+       scomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    cgemm_12x8(k, (const float*)alpha, (const float*)b, (const float*)a,
+               (const float*)beta, (float*)c, cs_c, rs_c);
+}
+
+void bli_zgemm_opt_12x4
+     (
+       dim_t               k,
+       dcomplex*  restrict alpha,
+       dcomplex*  restrict a,
+       dcomplex*  restrict b,
+       dcomplex*  restrict beta,
+       dcomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    zgemm_12x4(k, (const double*)alpha, (const double*)a, (const double*)b,
+               (const double*)beta, (double*)c, rs_c, cs_c);
+}
+
+void bli_zgemm_opt_4x12
+     (
+       dim_t               k,
+       dcomplex*  restrict alpha,
+       dcomplex*  restrict a,
+       dcomplex*  restrict b,
+       dcomplex*  restrict beta,
+       dcomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    zgemm_12x4(k, (const double*)alpha, (const double*)b, (const double*)a,
+               (const double*)beta, (double*)c, cs_c, rs_c);
+}
@@ -12,6 +12,12 @@ EXTERN_GEMM_UKR(double, bli_dgemm_opt_30x8);
 EXTERN_GEMM_UKR(double, bli_dgemm_opt_24x8);
 EXTERN_GEMM_UKR(double, bli_dgemm_opt_8x24);
 
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_12x8);
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_8x12);
+
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_12x4);
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_4x12);
+
 }
 
 namespace tblis
@@ -71,25 +77,27 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(knl_d24x8)
 
-    TBLIS_CONFIG_GEMM_MR    (_,    24, _, _)
-    TBLIS_CONFIG_GEMM_NR    (_,     8, _, _)
-    TBLIS_CONFIG_GEMM_KR    (_,     8, _, _)
-    TBLIS_CONFIG_GEMM_MC    (_,   120, _, _)
+    TBLIS_CONFIG_GEMM_MR    (_,    24,    12,    12)
+    TBLIS_CONFIG_GEMM_NR    (_,     8,     8,     4)
+    TBLIS_CONFIG_GEMM_KR    (_,     8,     8,     4)
+    TBLIS_CONFIG_GEMM_MC    (_,   120,   120,    60)
     //TBLIS_CONFIG_GEMM_MC_MAX(_,   120, _, _,
     //                         _,   144, _, _)
-    TBLIS_CONFIG_GEMM_NC    (_, 14400, _, _)
-    TBLIS_CONFIG_GEMM_KC_MAX(_,   336, _, _,
-                             _,   408, _, _)
+    TBLIS_CONFIG_GEMM_NC    (_, 14400, 14400,  7200)
+    TBLIS_CONFIG_GEMM_KC_MAX(_,   336,   336,   336,
+                             _,   408,   408,   408)
 
-    TBLIS_CONFIG_GEMM_UKR(_, bli_dgemm_opt_24x8, _, _)
+    TBLIS_CONFIG_GEMM_UKR(_, bli_dgemm_opt_24x8,
+                             bli_cgemm_opt_12x8,
+                             bli_zgemm_opt_12x4)
 
     TBLIS_CONFIG_PACK_NN_MR_UKR(_, knl_packm_24xk, _, _)
     TBLIS_CONFIG_PACK_NN_NR_UKR(_, knl_packm_8xk , _, _)
 
-    TBLIS_CONFIG_GEMM_ROW_MAJOR(_, true, _, _)
+    TBLIS_CONFIG_GEMM_ROW_MAJOR(_, true, true, true)
 
-    TBLIS_CONFIG_M_THREAD_RATIO(_, 4, _, _)
-    TBLIS_CONFIG_NR_MAX_THREAD(_, 1, _, _)
+    TBLIS_CONFIG_M_THREAD_RATIO(_, 4, 4, 4)
+    TBLIS_CONFIG_NR_MAX_THREAD(_, 1, 1, 1)
 
     TBLIS_CONFIG_CHECK(knl_check)
 
@@ -97,23 +105,25 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(knl_d8x24)
 
-    TBLIS_CONFIG_GEMM_MR    (_,     8, _, _)
-    TBLIS_CONFIG_GEMM_NR    (_,    24, _, _)
-    TBLIS_CONFIG_GEMM_KR    (_,     8, _, _)
-    TBLIS_CONFIG_GEMM_MC    (_,   120, _, _)
+    TBLIS_CONFIG_GEMM_MR    (_,     8,     8,     4)
+    TBLIS_CONFIG_GEMM_NR    (_,    24,    12,    12)
+    TBLIS_CONFIG_GEMM_KR    (_,     8,     8,     4)
+    TBLIS_CONFIG_GEMM_MC    (_,   120,   120,    60)
     //TBLIS_CONFIG_GEMM_MC_MAX(_,   120, _, _,
     //                         _,   144, _, _)
-    TBLIS_CONFIG_GEMM_NC    (_, 14400, _, _)
-    TBLIS_CONFIG_GEMM_KC_MAX(_,   336, _, _,
-                             _,   408, _, _)
+    TBLIS_CONFIG_GEMM_NC    (_, 14400, 14400,  7200)
+    TBLIS_CONFIG_GEMM_KC_MAX(_,   336,   336,   336,
+                             _,   408,   408,   408)
 
-    TBLIS_CONFIG_GEMM_UKR(_, bli_dgemm_opt_8x24, _, _)
+    TBLIS_CONFIG_GEMM_UKR(_, bli_dgemm_opt_8x24,
+                             bli_cgemm_opt_8x12,
+                             bli_zgemm_opt_4x12)
 
     TBLIS_CONFIG_PACK_NN_MR_UKR(_, knl_packm_8xk, _, _)
     TBLIS_CONFIG_PACK_NN_NR_UKR(_, knl_packm_24xk , _, _)
 
-    TBLIS_CONFIG_M_THREAD_RATIO(_, 16, _, _)
-    TBLIS_CONFIG_NR_MAX_THREAD(_, 1, _, _)
+    TBLIS_CONFIG_M_THREAD_RATIO(_, 16, 16, 16)
+    TBLIS_CONFIG_NR_MAX_THREAD(_, 1, 1, 1)
 
     TBLIS_CONFIG_CHECK(knl_check)
 
@@ -8,8 +8,41 @@ namespace tblis
 
 inline int reference_check() { return 0; }
 
+/*
+ * The register blocksizes are chosen so that the accumulators of the vector
+ * micro-kernel fill most of the register file of the target: 16 registers
+ * for SSE2 and AVX, and 32 for AVX-512 and NEON on AArch64. Complex types use
+ * the real kernels via the 1m method.
+ */
+
 TBLIS_BEGIN_CONFIG(reference)
 
+#if TBLIS_VECTOR_BYTES == 64
+
+TBLIS_CONFIG_GEMM_MR_EXTENT(  32,   16,   16,    8,
+                              32,   16,   32,   16)
+TBLIS_CONFIG_GEMM_NR       (  12,   12,   12,   12)
+
+#elif TBLIS_VECTOR_BYTES == 32 || defined(__aarch64__)
+
+TBLIS_CONFIG_GEMM_MR_EXTENT(  16,    8,    8,    4,
+                              16,    8,   16,    8)
+TBLIS_CONFIG_GEMM_NR       (   6,    6,    6,    6)
+
+#else
+
+TBLIS_CONFIG_GEMM_MR_EXTENT(   8,    4,    4,    2,
+                               8,    4,    8,    4)
+TBLIS_CONFIG_GEMM_NR       (   6,    6,    6,    6)
+
+#endif
+
+TBLIS_CONFIG_GEMM_MC       ( 512,  256,  256,  128)
+TBLIS_CONFIG_GEMM_NC       (4080, 4080, 4080, 4080)
+
+TBLIS_CONFIG_GEMM_1M_UKR((gemm_ukr_vec<this_config,   float>),
+                         (gemm_ukr_vec<this_config,  double>))
+
 TBLIS_CONFIG_CHECK(reference_check)
 
 TBLIS_END_CONFIG
@@ -0,0 +1,207 @@
+#include "../knl/bli_gemm_avx512_z12x4.h"
+
+/*
+ * Micro-kernels for the skx configuration.
+ *
+ * The real kernels are column-major: each k step loads one column of A into
+ * two zmm registers (16 doubles or 32 floats) and broadcasts each element of
+ * the row of B directly from memory, accumulating into two registers per
+ * column of C (28 for dgemm and 24 for sgemm). The complex kernels use the
+ * shared AVX-512 complex kernel bodies with B as the broadcast operand.
+ */
+
+#define REPEAT14(f) REPEAT12(f) f(12) f(13)
+
+#define GEMM_DECLARE_COL(j) ab_##j##_0, ab_##j##_1,
+
+#define GEMM_ZERO_COL(j) ab_##j##_0 = ab_##j##_1 = zero;
+
+#define GEMM_PREFETCH_COL(j) _mm_prefetch((const char*)(c + j*cs_c), _MM_HINT_T0);
+
+#define GEMM_STEP_COL(j) \
+    ab_##j##_0 = fmadd(a0, broadcast(b[j]), ab_##j##_0); \
+    ab_##j##_1 = fmadd(a1, broadcast(b[j]), ab_##j##_1);
+
+static inline void dgemm_16x14(dim_t k, const double* alpha,
+                               const double* a, const double* b,
+                               const double* beta,
+                               double* c, inc_t rs_c, inc_t cs_c)
+{
+    #define broadcast _mm512_set1_pd
+    #define fmadd _mm512_fmadd_pd
+
+    __m512d REPEAT14(GEMM_DECLARE_COL) a0, a1, zero = _mm512_setzero_pd();
+
+    REPEAT14(GEMM_ZERO_COL)
+    REPEAT14(GEMM_PREFETCH_COL)
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        a0 = _mm512_loadu_pd(a);
+        a1 = _mm512_loadu_pd(a + 8);
+
+        REPEAT14(GEMM_STEP_COL)
+
+        a += 16;
+        b += 14;
+    }
+
+    #undef broadcast
+    #undef fmadd
+
+    __m512d alpha_v = _mm512_set1_pd(*alpha);
+    __m512d beta_v = _mm512_set1_pd(*beta);
+    __m512i off = _mm512_set_epi64(7*rs_c, 6*rs_c, 5*rs_c, 4*rs_c,
+                                   3*rs_c, 2*rs_c,   rs_c,      0);
+
+    #define DGEMM_UPDATE_HALF(j, h) \
+    { \
+        double* cj = c + j*cs_c + 8*h*rs_c; \
+        __m512d ab = _mm512_mul_pd(alpha_v, ab_##j##_##h); \
+        if (rs_c == 1) \
+        { \
+            if (*beta != 0.0) \
+                ab = _mm512_fmadd_pd(beta_v, _mm512_loadu_pd(cj), ab); \
+            _mm512_storeu_pd(cj, ab); \
+        } \
+        else \
+        { \
+            if (*beta != 0.0) \
+                ab = _mm512_fmadd_pd(beta_v, _mm512_i64gather_pd(off, cj, 8), ab); \
+            _mm512_i64scatter_pd(cj, off, ab, 8); \
+        } \
+    }
+
+    #define DGEMM_UPDATE(j) DGEMM_UPDATE_HALF(j, 0) DGEMM_UPDATE_HALF(j, 1)
+
+    REPEAT14(DGEMM_UPDATE)
+
+    #undef DGEMM_UPDATE
+    #undef DGEMM_UPDATE_HALF
+}
+
+static inline void sgemm_32x12(dim_t k, const float* alpha,
+                               const float* a, const float* b,
+                               const float* beta,
+                               float* c, inc_t rs_c, inc_t cs_c)
+{
+    #define broadcast _mm512_set1_ps
+    #define fmadd _mm512_fmadd_ps
+
+    __m512 REPEAT12(GEMM_DECLARE_COL) a0, a1, zero = _mm512_setzero_ps();
+
+    REPEAT12(GEMM_ZERO_COL)
+    REPEAT12(GEMM_PREFETCH_COL)
+
+    for (dim_t p = 0;p < k;p++)
+    {
+        a0 = _mm512_loadu_ps(a);
+        a1 = _mm512_loadu_ps(a + 16);
+
+        REPEAT12(GEMM_STEP_COL)
+
+        a += 32;
+        b += 12;
+    }
+
+    #undef broadcast
+    #undef fmadd
+
+    __m512 alpha_v = _mm512_set1_ps(*alpha);
+    __m512 beta_v = _mm512_set1_ps(*beta);
+    __m512i off_lo = _mm512_set_epi64(7*rs_c, 6*rs_c, 5*rs_c, 4*rs_c,
+                                      3*rs_c, 2*rs_c,   rs_c,      0);
+    __m512i off_hi = _mm512_add_epi64(off_lo, _mm512_set1_epi64(8*rs_c));
+
+    #define SGEMM_UPDATE_HALF(j, h) \
+    { \
+        float* cj = c + j*cs_c + 16*h*rs_c; \
+        __m512 ab = _mm512_mul_ps(alpha_v, ab_##j##_##h); \
+        if (rs_c == 1) \
+        { \
+            if (*beta != 0.0f) \
+                ab = _mm512_fmadd_ps(beta_v, _mm512_loadu_ps(cj), ab); \
+            _mm512_storeu_ps(cj, ab); \
+        } \
+        else \
+        { \
+            if (*beta != 0.0f) \
+            { \
+                __m512 cv = _mm512_castps256_ps512(_mm512_i64gather_ps(off_lo, cj, 4)); \
+                cv = _mm512_insertf32x8(cv, _mm512_i64gather_ps(off_hi, cj, 4), 1); \
+                ab = _mm512_fmadd_ps(beta_v, cv, ab); \
+            } \
+            _mm512_i64scatter_ps(cj, off_lo, _mm512_castps512_ps256(ab), 4); \
+            _mm512_i64scatter_ps(cj, off_hi, _mm512_extractf32x8_ps(ab, 1), 4); \
+        } \
+    }
+
+    #define SGEMM_UPDATE(j) SGEMM_UPDATE_HALF(j, 0) SGEMM_UPDATE_HALF(j, 1)
+
+    REPEAT12(SGEMM_UPDATE)
+
+    #undef SGEMM_UPDATE
+    #undef SGEMM_UPDATE_HALF
+}
+
+void bli_sgemm_skx_32x12
+     (
+       dim_t               k,
+       float*     restrict alpha,
+       float*     restrict a,
+       float*     restrict b,
+       float*     restrict beta,
+       float*     restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    sgemm_32x12(k, alpha, a, b, beta, c, rs_c, cs_c);
+}
+
+void bli_dgemm_skx_16x14
+     (
+       dim_t               k,
+       double*    restrict alpha,
+       double*    restrict a,
+       double*    restrict b,
+       double*    restrict beta,
+       double*    restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    dgemm_16x14(k, alpha, a, b, beta, c, rs_c, cs_c);
+}
+
+void bli_cgemm_skx_8x12
+     (
+       dim_t               k,
+       scomplex*  restrict alpha,
+       scomplex*  restrict a,
+       scomplex*  restrict b,
+       scomplex*  restrict beta,
+       scomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    cgemm_12x8(k, (const float*)alpha, (const float*)b, (const float*)a,
+               (const float*)beta, (float*)c, cs_c, rs_c);
+}
+
+void bli_zgemm_skx_4x12
+     (
+       dim_t               k,
+       dcomplex*  restrict alpha,
+       dcomplex*  restrict a,
+       dcomplex*  restrict b,
+       dcomplex*  restrict beta,
+       dcomplex*  restrict c, inc_t rs_c, inc_t cs_c,
+       auxinfo_t* restrict data,
+       cntx_t*    restrict cntx
+     )
+{
+    zgemm_12x4(k, (const double*)alpha, (const double*)b, (const double*)a,
+               (const double*)beta, (double*)c, cs_c, rs_c);
+}
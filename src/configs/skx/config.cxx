@@ -0,0 +1,137 @@
+#include "util/cpuid.hpp"
+#include "config.hpp"
+
+#include <cstdlib>
+#include <immintrin.h>
+
+namespace tblis
+{
+
+/*
+ * Pack a full MR x k (or NR x k) panel with strided rows using gathers,
+ * which is faster than the scalar default when the panel is transposed with
+ * respect to the packed layout (rs_a != 1). Partial panels, unit row
+ * strides, and strides too large (in either direction) for 32-bit gather
+ * offsets use the AVX2 kernel.
+ */
+template <typename Config, int Mat>
+void skx_packm(len_type m, len_type k,
+               const float* p_a, stride_type rs_a, stride_type cs_a,
+               float* p_ap)
+{
+    using namespace matrix_constants;
+    constexpr len_type MR = (Mat == MAT_A ? Config::template gemm_mr<float>::def
+                                          : Config::template gemm_nr<float>::def);
+
+    if (m != MR || rs_a == 1 || std::abs(rs_a) > INT32_MAX/MR)
+    {
+        haswell_pack_nn<Config, float, Mat>(m, k, p_a, rs_a, cs_a, p_ap);
+        return;
+    }
+
+    __m512i off = _mm512_mullo_epi32(_mm512_set1_epi32(rs_a),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    for (len_type p = 0;p < k;p++)
+    {
+        for (len_type i = 0;i < MR;i += 16)
+        {
+            __mmask16 mask = (i+16 <= MR ? 0xffff : (1u << (MR-i)) - 1);
+            __m512 v = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, off,
+                                                p_a + i*rs_a, 4);
+            _mm512_mask_storeu_ps(p_ap + i, mask, v);
+        }
+
+        p_a += cs_a;
+        p_ap += MR;
+    }
+}
+
+template <typename Config, int Mat>
+void skx_packm(len_type m, len_type k,
+               const double* p_a, stride_type rs_a, stride_type cs_a,
+               double* p_ap)
+{
+    using namespace matrix_constants;
+    constexpr len_type MR = (Mat == MAT_A ? Config::template gemm_mr<double>::def
+                                          : Config::template gemm_nr<double>::def);
+
+    if (m != MR || rs_a == 1 || std::abs(rs_a) > INT32_MAX/MR)
+    {
+        haswell_pack_nn<Config, double, Mat>(m, k, p_a, rs_a, cs_a, p_ap);
+        return;
+    }
+
+    __m256i off = _mm256_mullo_epi32(_mm256_set1_epi32(rs_a),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    for (len_type p = 0;p < k;p++)
+    {
+        for (len_type i = 0;i < MR;i += 8)
+        {
+            __mmask8 mask = (i+8 <= MR ? 0xff : (1u << (MR-i)) - 1);
+            __m512d v = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, off,
+                                                 p_a + i*rs_a, 8);
+            _mm512_mask_storeu_pd(p_ap + i, mask, v);
+        }
+
+        p_a += cs_a;
+        p_ap += MR;
+    }
+}
+
+void skx_spackm_32xk(len_type m, len_type k,
+                     const float* p_a, stride_type rs_a, stride_type cs_a,
+                     float* p_ap)
+{
+    skx_packm<skx_config, matrix_constants::MAT_A>(m, k, p_a, rs_a, cs_a, p_ap);
+}
+
+void skx_spackm_12xk(len_type m, len_type k,
+                     const float* p_a, stride_type rs_a, stride_type cs_a,
+                     float* p_ap)
+{
+    skx_packm<skx_config, matrix_constants::MAT_B>(m, k, p_a, rs_a, cs_a, p_ap);
+}
+
+void skx_dpackm_16xk(len_type m, len_type k,
+                     const double* p_a, stride_type rs_a, stride_type cs_a,
+                     double* p_ap)
+{
+    skx_packm<skx_config, matrix_constants::MAT_A>(m, k, p_a, rs_a, cs_a, p_ap);
+}
+
+void skx_dpackm_14xk(len_type m, len_type k,
+                     const double* p_a, stride_type rs_a, stride_type cs_a,
+                     double* p_ap)
+{
+    skx_packm<skx_config, matrix_constants::MAT_B>(m, k, p_a, rs_a, cs_a, p_ap);
+}
+
+int skx_check()
+{
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+
+    if (vendor != VENDOR_INTEL ||
+        !check_features(features, FEATURE_AVX|
+                                  FEATURE_AVX2|
+                                  FEATURE_FMA3|
+                                  FEATURE_AVX512F|
+                                  FEATURE_AVX512DQ|
+                                  FEATURE_AVX512BW|
+                                  FEATURE_AVX512VL)) return -1;
+
+    /*
+     * With only one 512-bit FMA unit, AVX-512 has the same peak as AVX2, and
+     * the haswell kernels are preferred since they avoid frequency
+     * throttling.
+     */
+    if (get_avx512_fma_units() < 2) return 2;
+
+    return 4;
+}
+
+TBLIS_CONFIG_INSTANTIATE(skx);
+
+}
@@ -0,0 +1,71 @@
+#ifndef _TBLIS_CONFIGS_SKX_CONFIG_HPP_
+#define _TBLIS_CONFIGS_SKX_CONFIG_HPP_
+
+#include "configs/config_builder.hpp"
+#include "configs/haswell/pack_avx2.hpp"
+
+extern "C"
+{
+
+EXTERN_GEMM_UKR(           float, bli_sgemm_skx_32x12);
+EXTERN_GEMM_UKR(          double, bli_dgemm_skx_16x14);
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_skx_8x12);
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_skx_4x12);
+
+}
+
+namespace tblis
+{
+
+EXTERN_PACK_NN_UKR( float, skx_spackm_32xk);
+EXTERN_PACK_NN_UKR( float, skx_spackm_12xk);
+EXTERN_PACK_NN_UKR(double, skx_dpackm_16xk);
+EXTERN_PACK_NN_UKR(double, skx_dpackm_14xk);
+
+EXTERN_UPDATE_NN_UKR( float, skx_supdate_nn);
+EXTERN_UPDATE_SN_UKR( float, skx_supdate_sn);
+EXTERN_UPDATE_NS_UKR( float, skx_supdate_ns);
+EXTERN_UPDATE_SS_UKR( float, skx_supdate_ss);
+
+EXTERN_UPDATE_NN_UKR(double, skx_dupdate_nn);
+EXTERN_UPDATE_SN_UKR(double, skx_dupdate_sn);
+EXTERN_UPDATE_NS_UKR(double, skx_dupdate_ns);
+EXTERN_UPDATE_SS_UKR(double, skx_dupdate_ss);
+
+extern int skx_check();
+
+/*
+ * Skylake-SP and later server parts, with two 512-bit FMA units and a 1MB
+ * (or larger) L2. KC*MC of A fills about half of the L2, and KC*NR of B
+ * about half of the L1.
+ */
+TBLIS_BEGIN_CONFIG(skx)
+
+    TBLIS_CONFIG_GEMM_MR(  32,   16,    8,    4)
+    TBLIS_CONFIG_GEMM_NR(  12,   14,   12,   12)
+    TBLIS_CONFIG_GEMM_KR(  16,    8,    8,    4)
+    TBLIS_CONFIG_GEMM_MC( 480,  240,  240,  120)
+    TBLIS_CONFIG_GEMM_NC(3072, 3752, 3072, 1536)
+    TBLIS_CONFIG_GEMM_KC( 384,  256,  256,  256)
+
+    TBLIS_CONFIG_GEMM_UKR(bli_sgemm_skx_32x12,
+                          bli_dgemm_skx_16x14,
+                          bli_cgemm_skx_8x12,
+                          bli_zgemm_skx_4x12)
+
+    TBLIS_CONFIG_PACK_NN_MR_UKR(skx_spackm_32xk, skx_dpackm_16xk, _, _)
+    TBLIS_CONFIG_PACK_NN_NR_UKR(skx_spackm_12xk, skx_dpackm_14xk, _, _)
+    TBLIS_CONFIG_HASWELL_PACK_SCATTER_UKR
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(skx_supdate_nn, skx_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(skx_supdate_sn, skx_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(skx_supdate_ns, skx_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(skx_supdate_ss, skx_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_CHECK(skx_check)
+
+TBLIS_END_CONFIG
+
+}
+
+#endif
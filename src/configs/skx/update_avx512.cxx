@@ -0,0 +1,224 @@
+#include <immintrin.h>
+
+#include "config.hpp"
+
+namespace tblis
+{
+
+namespace
+{
+
+static_assert(sizeof(stride_type) == 8,
+              "The gathered updates load the scatter offsets as 64-bit integers");
+
+inline __mmask8 mask8(len_type n)
+{
+    return (n >= 8 ? 0xff : (1u << n) - 1);
+}
+
+inline __mmask16 mask16(len_type n)
+{
+    return (n >= 16 ? 0xffff : (1u << n) - 1);
+}
+
+/*
+ * Update an m x n block of C from AB, where AB has unit stride along m. If
+ * idx is null then C also has unit stride along m, otherwise it is gathered
+ * and scattered with the offsets in idx. Partial vectors use masks.
+ */
+
+void update_block(len_type m, len_type n,
+                  const double* TBLIS_RESTRICT p_ab, stride_type cs_ab, double beta,
+                  double* TBLIS_RESTRICT p_c, const stride_type* TBLIS_RESTRICT idx,
+                  stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    __m512d vbeta = _mm512_set1_pd(beta);
+    __mmask8 k = mask8(m%8);
+    len_type m8 = m - m%8;
+
+    for (len_type j = 0;j < n;j++)
+    {
+        const double* ab = p_ab + j*cs_ab;
+        double* c = p_c + (cscat_c ? cscat_c[j] : j*cs_c);
+
+        if (!idx)
+        {
+            if (beta == 0.0)
+            {
+                for (len_type i = 0;i < m8;i += 8)
+                    _mm512_storeu_pd(c+i, _mm512_loadu_pd(ab+i));
+                if (m8 < m)
+                    _mm512_mask_storeu_pd(c+m8, k, _mm512_maskz_loadu_pd(k, ab+m8));
+            }
+            else
+            {
+                for (len_type i = 0;i < m8;i += 8)
+                    _mm512_storeu_pd(c+i, _mm512_fmadd_pd(vbeta, _mm512_loadu_pd(c+i),
+                                                                 _mm512_loadu_pd(ab+i)));
+                if (m8 < m)
+                    _mm512_mask_storeu_pd(c+m8, k,
+                        _mm512_fmadd_pd(vbeta, _mm512_maskz_loadu_pd(k, c+m8),
+                                               _mm512_maskz_loadu_pd(k, ab+m8)));
+            }
+        }
+        else
+        {
+            for (len_type i = 0;i < m;i += 8)
+            {
+                __mmask8 ki = (i < m8 ? 0xff : k);
+                __m512i off = _mm512_maskz_loadu_epi64(ki, idx+i);
+                __m512d v = _mm512_maskz_loadu_pd(ki, ab+i);
+                if (beta != 0.0)
+                    v = _mm512_fmadd_pd(vbeta, _mm512_mask_i64gather_pd(
+                        _mm512_setzero_pd(), ki, off, c, 8), v);
+                _mm512_mask_i64scatter_pd(c, ki, off, v, 8);
+            }
+        }
+    }
+}
+
+void update_block(len_type m, len_type n,
+                  const float* TBLIS_RESTRICT p_ab, stride_type cs_ab, float beta,
+                  float* TBLIS_RESTRICT p_c, const stride_type* TBLIS_RESTRICT idx,
+                  stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    __m512 vbeta = _mm512_set1_ps(beta);
+    __mmask16 k = mask16(m%16);
+    len_type m16 = m - m%16;
+
+    /*
+     * Only eight 64-bit offsets fit in a register, so gathers use 256-bit
+     * vectors.
+     */
+    __m256 vbeta8 = _mm256_set1_ps(beta);
+    __mmask8 k8 = mask8(m%8);
+    len_type m8 = m - m%8;
+
+    for (len_type j = 0;j < n;j++)
+    {
+        const float* ab = p_ab + j*cs_ab;
+        float* c = p_c + (cscat_c ? cscat_c[j] : j*cs_c);
+
+        if (!idx)
+        {
+            if (beta == 0.0f)
+            {
+                for (len_type i = 0;i < m16;i += 16)
+                    _mm512_storeu_ps(c+i, _mm512_loadu_ps(ab+i));
+                if (m16 < m)
+                    _mm512_mask_storeu_ps(c+m16, k, _mm512_maskz_loadu_ps(k, ab+m16));
+            }
+            else
+            {
+                for (len_type i = 0;i < m16;i += 16)
+                    _mm512_storeu_ps(c+i, _mm512_fmadd_ps(vbeta, _mm512_loadu_ps(c+i),
+                                                                 _mm512_loadu_ps(ab+i)));
+                if (m16 < m)
+                    _mm512_mask_storeu_ps(c+m16, k,
+                        _mm512_fmadd_ps(vbeta, _mm512_maskz_loadu_ps(k, c+m16),
+                                               _mm512_maskz_loadu_ps(k, ab+m16)));
+            }
+        }
+        else
+        {
+            for (len_type i = 0;i < m;i += 8)
+            {
+                __mmask8 ki = (i < m8 ? 0xff : k8);
+                __m512i off = _mm512_maskz_loadu_epi64(ki, idx+i);
+                __m256 v = _mm256_maskz_loadu_ps(ki, ab+i);
+                if (beta != 0.0f)
+                    v = _mm256_fmadd_ps(vbeta8, _mm512_mask_i64gather_ps(
+                        _mm256_setzero_ps(), ki, off, c, 4), v);
+                _mm512_mask_i64scatter_ps(c, ki, off, v, 4);
+            }
+        }
+    }
+}
+
+/*
+ * Vectorize along the unit-stride dimension of AB. A null scatter vector
+ * means that the corresponding constant stride is used instead.
+ */
+template <typename T>
+void update(len_type m, len_type n,
+            const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+            T beta, T* TBLIS_RESTRICT p_c,
+            stride_type rs_c, const stride_type* TBLIS_RESTRICT rscat_c,
+            stride_type cs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    if (rs_ab != 1)
+    {
+        std::swap(m, n);
+        std::swap(rs_ab, cs_ab);
+        std::swap(rs_c, cs_c);
+        std::swap(rscat_c, cscat_c);
+    }
+
+    if (rs_ab != 1)
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                T& c = p_c[(rscat_c ? rscat_c[i] : i*rs_c) +
+                           (cscat_c ? cscat_c[j] : j*cs_c)];
+                c = p_ab[i*rs_ab + j*cs_ab] + (beta == T(0) ? T(0) : beta*c);
+            }
+        }
+
+        return;
+    }
+
+    TBLIS_ASSERT(m <= 512);
+
+    stride_type idx[512];
+
+    if (!rscat_c && rs_c != 1)
+    {
+        for (len_type i = 0;i < m;i++) idx[i] = i*rs_c;
+        rscat_c = idx;
+    }
+
+    update_block(m, n, p_ab, cs_ab, beta, p_c, rscat_c, cs_c, cscat_c);
+}
+
+}
+
+#define UPDATE_KERNELS(T, ch) \
+\
+void skx_##ch##update_nn(len_type m, len_type n, \
+                         const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                         const T* beta, \
+                         T* p_c, stride_type rs_c, stride_type cs_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, rs_c, nullptr, cs_c, nullptr); \
+} \
+\
+void skx_##ch##update_sn(len_type m, len_type n, \
+                         const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                         const T* beta, \
+                         T* p_c, const stride_type* rscat_c, stride_type cs_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, 0, rscat_c, cs_c, nullptr); \
+} \
+\
+void skx_##ch##update_ns(len_type m, len_type n, \
+                         const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                         const T* beta, \
+                         T* p_c, stride_type rs_c, const stride_type* cscat_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, rs_c, nullptr, 0, cscat_c); \
+} \
+\
+void skx_##ch##update_ss(len_type m, len_type n, \
+                         const T* p_ab, stride_type rs_ab, stride_type cs_ab, \
+                         const T* beta, \
+                         T* p_c, const stride_type* rscat_c, const stride_type* cscat_c) \
+{ \
+    update(m, n, p_ab, rs_ab, cs_ab, *beta, p_c, 0, rscat_c, 0, cscat_c); \
+}
+
+UPDATE_KERNELS( float, s)
+UPDATE_KERNELS(double, d)
+
+}
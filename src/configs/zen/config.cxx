@@ -0,0 +1,36 @@
+#include "util/cpuid.hpp"
+#include "config.hpp"
+
+namespace tblis
+{
+
+int zen_check()
+{
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+
+    if (vendor != VENDOR_AMD ||
+        !check_features(features, FEATURE_AVX|
+                                  FEATURE_AVX2|
+                                  FEATURE_FMA3)) return -1;
+
+    /*
+     * Zen is family 0x17 (Zen, Zen+, Zen 2), 0x19 (Zen 3, Zen 4), and 0x1A
+     * (Zen 5).
+     */
+    if (family < 0x17)
+        return -1;
+
+    return 4;
+}
+
+int zen_l3_cores()
+{
+    static int l3_cores = get_cores_per_l3();
+    return l3_cores;
+}
+
+TBLIS_CONFIG_INSTANTIATE(zen_d8x6);
+TBLIS_CONFIG_INSTANTIATE(zen_d6x8);
+
+}
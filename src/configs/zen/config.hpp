@@ -0,0 +1,110 @@
+#ifndef _TBLIS_CONFIGS_ZEN_CONFIG_HPP_
+#define _TBLIS_CONFIGS_ZEN_CONFIG_HPP_
+
+#include "configs/config_builder.hpp"
+#include "configs/haswell/pack_avx2.hpp"
+
+/*
+ * These are the same kernels as Haswell.
+ */
+
+extern "C"
+{
+
+EXTERN_GEMM_UKR( float, bli_sgemm_asm_16x6);
+EXTERN_GEMM_UKR( float, bli_sgemm_asm_6x16);
+
+EXTERN_GEMM_UKR(double, bli_dgemm_asm_8x6);
+EXTERN_GEMM_UKR(double, bli_dgemm_asm_6x8);
+
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_8x3);
+EXTERN_GEMM_UKR(tblis::scomplex, bli_cgemm_opt_3x8);
+
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_4x3);
+EXTERN_GEMM_UKR(tblis::dcomplex, bli_zgemm_opt_3x4);
+
+}
+
+namespace tblis
+{
+
+EXTERN_UPDATE_NN_UKR( float, haswell_supdate_nn);
+EXTERN_UPDATE_SN_UKR( float, haswell_supdate_sn);
+EXTERN_UPDATE_NS_UKR( float, haswell_supdate_ns);
+EXTERN_UPDATE_SS_UKR( float, haswell_supdate_ss);
+
+EXTERN_UPDATE_NN_UKR(double, haswell_dupdate_nn);
+EXTERN_UPDATE_SN_UKR(double, haswell_dupdate_sn);
+EXTERN_UPDATE_NS_UKR(double, haswell_dupdate_ns);
+EXTERN_UPDATE_SS_UKR(double, haswell_dupdate_ss);
+
+extern int zen_check();
+extern int zen_l3_cores();
+
+/*
+ * Zen has twice the L2 of Haswell (512KB, 1MB on Zen 4), so MC is doubled,
+ * and KC is chosen so that a micro-panel of B takes half of the 32KB L1 for
+ * all types. The L3 is split between CCXs (16MB per 4 cores on Zen 2, 32MB per
+ * 8 cores on Zen 3 and later) and NC is chosen so that the packed panel of B
+ * takes half of it; zen_l3_cores ensures that each CCX gets its own panel.
+ */
+
+TBLIS_BEGIN_CONFIG(zen_d8x6)
+
+    TBLIS_CONFIG_GEMM_MR(  16,    8,    8,    4)
+    TBLIS_CONFIG_GEMM_NR(   6,    6,    3,    3)
+    TBLIS_CONFIG_GEMM_KR(   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC( 288,  144,  144,   72)
+    TBLIS_CONFIG_GEMM_NC(8160, 4080, 4080, 2040)
+    TBLIS_CONFIG_GEMM_KC( 256,  256,  256,  256)
+
+    TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_16x6,
+                          bli_dgemm_asm_8x6,
+                          bli_cgemm_opt_8x3,
+                          bli_zgemm_opt_4x3)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_HASWELL_PACK_UKR
+
+    TBLIS_CONFIG_CHECK(zen_check)
+    TBLIS_CONFIG_L3_CORES(zen_l3_cores)
+
+TBLIS_END_CONFIG
+
+TBLIS_BEGIN_CONFIG(zen_d6x8)
+
+    TBLIS_CONFIG_GEMM_MR(   6,    6,    3,    3)
+    TBLIS_CONFIG_GEMM_NR(  16,    8,    8,    4)
+    TBLIS_CONFIG_GEMM_KR(   8,    4,    4,    2)
+    TBLIS_CONFIG_GEMM_MC( 288,  144,  144,   72)
+    TBLIS_CONFIG_GEMM_NC(8160, 4080, 4080, 2040)
+    TBLIS_CONFIG_GEMM_KC( 256,  256,  256,  256)
+
+    TBLIS_CONFIG_GEMM_UKR(bli_sgemm_asm_6x16,
+                          bli_dgemm_asm_6x8,
+                          bli_cgemm_opt_3x8,
+                          bli_zgemm_opt_3x4)
+
+    TBLIS_CONFIG_UPDATE_NN_UKR(haswell_supdate_nn, haswell_dupdate_nn, _, _)
+    TBLIS_CONFIG_UPDATE_SN_UKR(haswell_supdate_sn, haswell_dupdate_sn, _, _)
+    TBLIS_CONFIG_UPDATE_NS_UKR(haswell_supdate_ns, haswell_dupdate_ns, _, _)
+    TBLIS_CONFIG_UPDATE_SS_UKR(haswell_supdate_ss, haswell_dupdate_ss, _, _)
+
+    TBLIS_CONFIG_HASWELL_PACK_UKR
+
+    TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, true, true)
+
+    TBLIS_CONFIG_CHECK(zen_check)
+    TBLIS_CONFIG_L3_CORES(zen_l3_cores)
+
+TBLIS_END_CONFIG
+
+typedef zen_d6x8_config zen_config;
+
+}
+
+#endif
@@ -6,16 +6,52 @@
 #include "internal/1t/set.hpp"
 #include "internal/3t/mult.hpp"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace tblis
 {
 
-extern "C"
+struct tblis_tensor_mult_plan
 {
+    type_t type;
+    bool conj_A, conj_B, conj_C;
+    impl_t impl;
+    /*
+     * Executing a plan doesn't modify it otherwise, so several threads may
+     * execute the same plan at once.
+     */
+    mutable std::atomic<impl_t> selected_impl;
+    tblis_epilogue epilogue;
 
-void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
-                       const tblis_tensor* A, const label_type* idx_A_,
-                       const tblis_tensor* B, const label_type* idx_B_,
-                             tblis_tensor* C, const label_type* idx_C_)
+    /*
+     * Besides the plan itself, the implementation chosen when impl is
+     * AUTOMATIC and the layout used by the BLIS-based implementation only
+     * depend on the configuration (and its revision) and the number of
+     * threads, so they are kept for the last ones that the plan was executed
+     * with. One-off products (keep == false) don't bother.
+     */
+    bool keep = false;
+    mutable std::mutex cache_lock;
+    mutable unsigned long cache_revision = 0;
+    mutable unsigned cache_nthread = 0;
+    mutable impl_t cache_impl = AUTOMATIC;
+    mutable std::shared_ptr<const void> cache_layout;
+
+    std::vector<len_type> len_A_only, len_B_only, len_C_only;
+    std::vector<len_type> len_AB, len_AC, len_BC, len_ABC;
+    std::vector<stride_type> stride_A_only, stride_A_AB, stride_A_AC, stride_A_ABC;
+    std::vector<stride_type> stride_B_only, stride_B_AB, stride_B_BC, stride_B_ABC;
+    std::vector<stride_type> stride_C_only, stride_C_AC, stride_C_BC, stride_C_ABC;
+    std::vector<len_type> len_C_all;
+    std::vector<stride_type> stride_C_all;
+};
+
+static void init_mult_plan(tblis_tensor_mult_plan& plan,
+                           const tblis_tensor* A, const label_type* idx_A_,
+                           const tblis_tensor* B, const label_type* idx_B_,
+                           const tblis_tensor* C, const label_type* idx_C_)
 {
     TBLIS_ASSERT(A->type == B->type);
     TBLIS_ASSERT(A->type == C->type);
@@ -39,40 +75,40 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
     diagonal(ndim_C, C->len, C->stride, idx_C_, len_C, stride_C, idx_C);
 
     auto idx_ABC = stl_ext::intersection(idx_A, idx_B, idx_C);
-    auto len_ABC = stl_ext::select_from(len_A, idx_A, idx_ABC);
-    TBLIS_ASSERT(len_ABC == stl_ext::select_from(len_B, idx_B, idx_ABC));
-    TBLIS_ASSERT(len_ABC == stl_ext::select_from(len_C, idx_C, idx_ABC));
-    auto stride_A_ABC = stl_ext::select_from(stride_A, idx_A, idx_ABC);
-    auto stride_B_ABC = stl_ext::select_from(stride_B, idx_B, idx_ABC);
-    auto stride_C_ABC = stl_ext::select_from(stride_C, idx_C, idx_ABC);
+    plan.len_ABC = stl_ext::select_from(len_A, idx_A, idx_ABC);
+    TBLIS_ASSERT(plan.len_ABC == stl_ext::select_from(len_B, idx_B, idx_ABC));
+    TBLIS_ASSERT(plan.len_ABC == stl_ext::select_from(len_C, idx_C, idx_ABC));
+    plan.stride_A_ABC = stl_ext::select_from(stride_A, idx_A, idx_ABC);
+    plan.stride_B_ABC = stl_ext::select_from(stride_B, idx_B, idx_ABC);
+    plan.stride_C_ABC = stl_ext::select_from(stride_C, idx_C, idx_ABC);
 
     auto idx_AB = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_B), idx_ABC);
-    auto len_AB = stl_ext::select_from(len_A, idx_A, idx_AB);
-    TBLIS_ASSERT(len_AB == stl_ext::select_from(len_B, idx_B, idx_AB));
-    auto stride_A_AB = stl_ext::select_from(stride_A, idx_A, idx_AB);
-    auto stride_B_AB = stl_ext::select_from(stride_B, idx_B, idx_AB);
+    plan.len_AB = stl_ext::select_from(len_A, idx_A, idx_AB);
+    TBLIS_ASSERT(plan.len_AB == stl_ext::select_from(len_B, idx_B, idx_AB));
+    plan.stride_A_AB = stl_ext::select_from(stride_A, idx_A, idx_AB);
+    plan.stride_B_AB = stl_ext::select_from(stride_B, idx_B, idx_AB);
 
     auto idx_AC = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_C), idx_ABC);
-    auto len_AC = stl_ext::select_from(len_A, idx_A, idx_AC);
-    TBLIS_ASSERT(len_AC == stl_ext::select_from(len_C, idx_C, idx_AC));
-    auto stride_A_AC = stl_ext::select_from(stride_A, idx_A, idx_AC);
-    auto stride_C_AC = stl_ext::select_from(stride_C, idx_C, idx_AC);
+    plan.len_AC = stl_ext::select_from(len_A, idx_A, idx_AC);
+    TBLIS_ASSERT(plan.len_AC == stl_ext::select_from(len_C, idx_C, idx_AC));
+    plan.stride_A_AC = stl_ext::select_from(stride_A, idx_A, idx_AC);
+    plan.stride_C_AC = stl_ext::select_from(stride_C, idx_C, idx_AC);
 
     auto idx_BC = stl_ext::exclusion(stl_ext::intersection(idx_B, idx_C), idx_ABC);
-    auto len_BC = stl_ext::select_from(len_B, idx_B, idx_BC);
-    TBLIS_ASSERT(len_BC == stl_ext::select_from(len_C, idx_C, idx_BC));
-    auto stride_B_BC = stl_ext::select_from(stride_B, idx_B, idx_BC);
-    auto stride_C_BC = stl_ext::select_from(stride_C, idx_C, idx_BC);
+    plan.len_BC = stl_ext::select_from(len_B, idx_B, idx_BC);
+    TBLIS_ASSERT(plan.len_BC == stl_ext::select_from(len_C, idx_C, idx_BC));
+    plan.stride_B_BC = stl_ext::select_from(stride_B, idx_B, idx_BC);
+    plan.stride_C_BC = stl_ext::select_from(stride_C, idx_C, idx_BC);
 
     auto idx_A_only = stl_ext::exclusion(idx_A, idx_AB, idx_AC, idx_ABC);
-    auto len_A_only = stl_ext::select_from(len_A, idx_A, idx_A_only);
-    auto stride_A_only = stl_ext::select_from(stride_A, idx_A, idx_A_only);
+    plan.len_A_only = stl_ext::select_from(len_A, idx_A, idx_A_only);
+    plan.stride_A_only = stl_ext::select_from(stride_A, idx_A, idx_A_only);
     auto idx_B_only = stl_ext::exclusion(idx_B, idx_AB, idx_BC, idx_ABC);
-    auto len_B_only = stl_ext::select_from(len_B, idx_B, idx_B_only);
-    auto stride_B_only = stl_ext::select_from(stride_B, idx_B, idx_B_only);
+    plan.len_B_only = stl_ext::select_from(len_B, idx_B, idx_B_only);
+    plan.stride_B_only = stl_ext::select_from(stride_B, idx_B, idx_B_only);
     auto idx_C_only = stl_ext::exclusion(idx_C, idx_AC, idx_BC, idx_ABC);
-    auto len_C_only = stl_ext::select_from(len_C, idx_C, idx_C_only);
-    auto stride_C_only = stl_ext::select_from(stride_C, idx_C, idx_C_only);
+    plan.len_C_only = stl_ext::select_from(len_C, idx_C, idx_C_only);
+    plan.stride_C_only = stl_ext::select_from(stride_C, idx_C, idx_C_only);
 
     TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_B_only).empty());
     TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_C_only).empty());
@@ -96,54 +132,409 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
     TBLIS_ASSERT(stl_ext::intersection(idx_AC, idx_ABC).empty());
     TBLIS_ASSERT(stl_ext::intersection(idx_BC, idx_ABC).empty());
 
-    fold(len_ABC, idx_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
-    fold(len_AB, idx_AB, stride_A_AB, stride_B_AB);
-    fold(len_AC, idx_AC, stride_A_AC, stride_C_AC);
-    fold(len_BC, idx_BC, stride_B_BC, stride_C_BC);
-    fold(len_A_only, idx_A_only, stride_A_only);
-    fold(len_B_only, idx_B_only, stride_B_only);
-    fold(len_C_only, idx_C_only, stride_C_only);
+    fold(plan.len_ABC, idx_ABC, plan.stride_A_ABC, plan.stride_B_ABC, plan.stride_C_ABC);
+    fold(plan.len_AB, idx_AB, plan.stride_A_AB, plan.stride_B_AB);
+    fold(plan.len_AC, idx_AC, plan.stride_A_AC, plan.stride_C_AC);
+    fold(plan.len_BC, idx_BC, plan.stride_B_BC, plan.stride_C_BC);
+    fold(plan.len_A_only, idx_A_only, plan.stride_A_only);
+    fold(plan.len_B_only, idx_B_only, plan.stride_B_only);
+    fold(plan.len_C_only, idx_C_only, plan.stride_C_only);
 
-    TBLIS_WITH_TYPE_AS(A->type, T,
+    plan.len_C_all = plan.len_C_only + plan.len_AC + plan.len_BC + plan.len_ABC;
+    plan.stride_C_all = plan.stride_C_only + plan.stride_C_AC +
+                        plan.stride_C_BC + plan.stride_C_ABC;
+
+    plan.type = A->type;
+    plan.conj_A = A->conj;
+    plan.conj_B = B->conj;
+    plan.conj_C = C->conj;
+    plan.impl = internal::impl;
+    plan.selected_impl.store(plan.impl, std::memory_order_relaxed);
+    plan.epilogue.func = nullptr;
+    plan.epilogue.data = nullptr;
+}
+
+template <typename T>
+impl_t select_mult_impl(const config& cfg, unsigned nthread,
+                        const tblis_tensor_mult_plan& plan)
+{
+    if (plan.impl != AUTOMATIC) return plan.impl;
+
+    return internal::select_impl<T>(cfg, nthread,
+        plan.len_A_only, plan.len_B_only, plan.len_C_only,
+        plan.len_AB, plan.len_AC, plan.len_BC, plan.len_ABC,
+        plan.stride_A_only, plan.stride_A_AB, plan.stride_A_AC, plan.stride_A_ABC,
+        plan.stride_B_only, plan.stride_B_AB, plan.stride_B_BC, plan.stride_B_ABC,
+        plan.stride_C_only, plan.stride_C_AC, plan.stride_C_BC, plan.stride_C_ABC);
+}
+
+/*
+ * Return the implementation for a team of nthread threads, along with the
+ * layout for the BLIS-based implementation (if that is the one chosen),
+ * computing them only if the configuration or number of threads changed
+ * since the last time. The layout is shared, so that a thread which is still
+ * using an old one is not affected if it is replaced.
+ */
+template <typename T>
+std::shared_ptr<const internal::mult_layout<T>>
+cached_mult_layout(const config& cfg, unsigned nthread,
+                   const tblis_tensor_mult_plan& plan, impl_t& impl)
+{
+    std::lock_guard<std::mutex> guard(plan.cache_lock);
+
+    if (plan.cache_revision != cfg.revision || plan.cache_nthread != nthread)
+    {
+        plan.cache_impl = select_mult_impl<T>(cfg, nthread, plan);
+        plan.cache_layout.reset();
+
+        if (plan.cache_impl == BLIS_BASED)
+        {
+            auto layout = std::make_shared<internal::mult_layout<T>>();
+            parallelize_if(internal::init_mult_layout<T>, tblis_single,
+                           cfg, nthread, *layout,
+                           plan.len_A_only, plan.len_B_only, plan.len_C_only,
+                           plan.len_AB, plan.len_AC, plan.len_BC, plan.len_ABC,
+                           plan.stride_A_only, plan.stride_A_AB, plan.stride_A_AC,
+                           plan.stride_B_only, plan.stride_B_AB, plan.stride_B_BC,
+                           plan.stride_C_only, plan.stride_C_AC, plan.stride_C_BC);
+            plan.cache_layout = layout;
+        }
+
+        plan.cache_revision = cfg.revision;
+        plan.cache_nthread = nthread;
+    }
+
+    impl = plan.cache_impl;
+    return std::static_pointer_cast<const internal::mult_layout<T>>(plan.cache_layout);
+}
+
+template <typename T>
+void execute_mult_plan(const tblis_comm* comm, const tblis_config* cfg,
+                       const tblis_tensor_mult_plan& plan,
+                       T alpha, const T* A, const T* B, T beta, T* C)
+{
+    const tblis_epilogue* epilogue = plan.epilogue.func ? &plan.epilogue : nullptr;
+
+    if (alpha == T(0))
+    {
+        if (beta == T(0))
+        {
+            parallelize_if(internal::set<T>, comm, get_config(cfg),
+                           plan.len_C_all, T(0), C, plan.stride_C_all);
+        }
+        else
+        {
+            parallelize_if(internal::scale<T>, comm, get_config(cfg),
+                           plan.len_C_all, beta, plan.conj_C, C, plan.stride_C_all);
+        }
+
+        if (epilogue)
+        {
+            parallelize_if(internal::apply_epilogue<T>, comm,
+                           plan.len_C_all, C, plan.stride_C_all, epilogue);
+        }
+    }
+    else
+    {
+        unsigned nt = (comm ? reinterpret_cast<const communicator*>(comm)->num_threads()
+                            : tblis_get_num_threads());
+
+        impl_t impl;
+        std::shared_ptr<const internal::mult_layout<T>> layout;
+
+        if (plan.keep)
+            layout = cached_mult_layout<T>(get_config(cfg), nt, plan, impl);
+        else
+            impl = select_mult_impl<T>(get_config(cfg), nt, plan);
+
+        plan.selected_impl.store(impl, std::memory_order_relaxed);
+
+        /*
+         * Small contractions run on the calling thread only, rather than
+         * starting up a thread team just to have it wait.
+         */
+        if (impl == SMALL_TENSOR && !comm) comm = tblis_single;
+
+        parallelize_if(internal::mult<T>, comm, get_config(cfg), impl,
+                       plan.len_A_only, plan.len_B_only, plan.len_C_only,
+                       plan.len_AB, plan.len_AC, plan.len_BC, plan.len_ABC,
+                       alpha, plan.conj_A, A,
+                       plan.stride_A_only, plan.stride_A_AB,
+                       plan.stride_A_AC, plan.stride_A_ABC,
+                              plan.conj_B, B,
+                       plan.stride_B_only, plan.stride_B_AB,
+                       plan.stride_B_BC, plan.stride_B_ABC,
+                        beta, plan.conj_C, C,
+                       plan.stride_C_only, plan.stride_C_AC,
+                       plan.stride_C_BC, plan.stride_C_ABC, epilogue, layout.get());
+    }
+}
+
+/*
+ * Check whether a sum of contractions can be fused into a single
+ * contraction concatenated along k: every term must contract A_i and B_i
+ * over their shared indices only, and the indices of C must come from A_i
+ * and B_i in the same way for every term.
+ */
+template <typename T>
+static bool mult_sum(const tblis_comm* comm, const tblis_config* cfg,
+                     unsigned nterm,
+                     const tblis_tensor* const* A, const label_type* const* idx_A_,
+                     const tblis_tensor* const* B, const label_type* const* idx_B_,
+                           tblis_tensor* C, const label_type* idx_C_)
+{
+    unsigned ndim_C = C->ndim;
+    std::vector<len_type> len_C;
+    std::vector<stride_type> stride_C;
+    std::vector<label_type> idx_C;
+    diagonal(ndim_C, C->len, C->stride, idx_C_, len_C, stride_C, idx_C);
+
+    T beta = C->alpha<T>();
+    T* data_C = static_cast<T*>(C->data);
+
+    /*
+     * With no terms at all, C = beta*C.
+     */
+    if (nterm == 0)
+    {
+        fold(len_C, idx_C, stride_C);
+
+        if (beta == T(0))
+        {
+            parallelize_if(internal::set<T>, comm, get_config(cfg),
+                           len_C, T(0), data_C, stride_C);
+        }
+        else
+        {
+            parallelize_if(internal::scale<T>, comm, get_config(cfg),
+                           len_C, beta, C->conj, data_C, stride_C);
+        }
+
+        C->alpha<T>() = T(1);
+        C->conj = false;
+
+        return true;
+    }
+
+    std::vector<label_type> idx_AC, idx_BC;
+    std::vector<std::vector<len_type>> len_AB(nterm);
+    std::vector<T> alpha(nterm);
+    std::vector<bool> conj_A(nterm), conj_B(nterm);
+    std::vector<const T*> data_A(nterm), data_B(nterm);
+    std::vector<std::vector<stride_type>> stride_A_AB(nterm), stride_A_AC(nterm);
+    std::vector<std::vector<stride_type>> stride_B_AB(nterm), stride_B_BC(nterm);
+
+    for (unsigned i = 0;i < nterm;i++)
+    {
+        TBLIS_ASSERT(A[i]->type == C->type);
+        TBLIS_ASSERT(B[i]->type == C->type);
+
+        unsigned ndim_A = A[i]->ndim;
+        std::vector<len_type> len_A;
+        std::vector<stride_type> stride_A;
+        std::vector<label_type> idx_A;
+        diagonal(ndim_A, A[i]->len, A[i]->stride, idx_A_[i], len_A, stride_A, idx_A);
+
+        unsigned ndim_B = B[i]->ndim;
+        std::vector<len_type> len_B;
+        std::vector<stride_type> stride_B;
+        std::vector<label_type> idx_B;
+        diagonal(ndim_B, B[i]->len, B[i]->stride, idx_B_[i], len_B, stride_B, idx_B);
+
+        auto idx_AB = stl_ext::intersection(idx_A, idx_B);
+        auto idx_AC_i = stl_ext::intersection(idx_A, idx_C);
+        auto idx_BC_i = stl_ext::intersection(idx_B, idx_C);
+
+        if (i == 0)
+        {
+            idx_AC = idx_AC_i;
+            idx_BC = idx_BC_i;
+        }
+
+        if (idx_AC_i != idx_AC || idx_BC_i != idx_BC ||
+            !stl_ext::intersection(idx_AB, idx_C).empty() ||
+            !stl_ext::exclusion(idx_A, idx_AB, idx_AC).empty() ||
+            !stl_ext::exclusion(idx_B, idx_AB, idx_BC).empty() ||
+            !stl_ext::exclusion(idx_C, idx_AC, idx_BC).empty()) return false;
+
+        len_AB[i] = stl_ext::select_from(len_A, idx_A, idx_AB);
+        TBLIS_ASSERT(len_AB[i] == stl_ext::select_from(len_B, idx_B, idx_AB));
+        TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_AC) ==
+                     stl_ext::select_from(len_C, idx_C, idx_AC));
+        TBLIS_ASSERT(stl_ext::select_from(len_B, idx_B, idx_BC) ==
+                     stl_ext::select_from(len_C, idx_C, idx_BC));
+        stride_A_AB[i] = stl_ext::select_from(stride_A, idx_A, idx_AB);
+        stride_A_AC[i] = stl_ext::select_from(stride_A, idx_A, idx_AC);
+        stride_B_AB[i] = stl_ext::select_from(stride_B, idx_B, idx_AB);
+        stride_B_BC[i] = stl_ext::select_from(stride_B, idx_B, idx_BC);
+
+        fold(len_AB[i], idx_AB, stride_A_AB[i], stride_B_AB[i]);
+
+        alpha[i] = A[i]->alpha<T>()*B[i]->alpha<T>();
+        conj_A[i] = A[i]->conj;
+        conj_B[i] = B[i]->conj;
+        data_A[i] = static_cast<const T*>(A[i]->data);
+        data_B[i] = static_cast<const T*>(B[i]->data);
+    }
+
+    auto len_AC = stl_ext::select_from(len_C, idx_C, idx_AC);
+    auto len_BC = stl_ext::select_from(len_C, idx_C, idx_BC);
+    auto stride_C_AC = stl_ext::select_from(stride_C, idx_C, idx_AC);
+    auto stride_C_BC = stl_ext::select_from(stride_C, idx_C, idx_BC);
+
+    len_type k = 0;
+    for (auto& len : len_AB) k += stl_ext::prod(len);
+
+    if (stl_ext::prod(len_AC)*stl_ext::prod(len_BC) == 0)
     {
-        T alpha = A->alpha<T>()*B->alpha<T>();
-        T beta = C->alpha<T>();
+        // Nothing to do
+    }
+    else if (k == 0)
+    {
+        auto len_C_all = len_AC + len_BC;
+        auto stride_C_all = stride_C_AC + stride_C_BC;
 
-        if (alpha == T(0))
+        if (beta == T(0))
         {
-            if (beta == T(0))
-            {
-                parallelize_if(internal::set<T>, comm, get_config(cfg),
-                               len_C_only+len_AC+len_BC+len_ABC,
-                               T(0), static_cast<T*>(C->data),
-                               stride_C_only+stride_C_AC+stride_C_BC+stride_C_ABC);
-            }
-            else
-            {
-                parallelize_if(internal::scale<T>, comm, get_config(cfg),
-                               len_C_only+len_AC+len_BC+len_ABC,
-                               beta, C->conj, static_cast<T*>(C->data),
-                               stride_C_only+stride_C_AC+stride_C_BC+stride_C_ABC);
-            }
+            parallelize_if(internal::set<T>, comm, get_config(cfg),
+                           len_C_all, T(0), data_C, stride_C_all);
         }
         else
         {
-            parallelize_if(internal::mult<T>, comm, get_config(cfg),
-                           len_A_only, len_B_only, len_C_only,
-                           len_AB, len_AC, len_BC, len_ABC,
-                           alpha, A->conj, static_cast<const T*>(A->data),
-                           stride_A_only, stride_A_AB, stride_A_AC, stride_A_ABC,
-                                  B->conj, static_cast<const T*>(B->data),
-                           stride_B_only, stride_B_AB, stride_B_BC, stride_B_ABC,
-                            beta, C->conj,       static_cast<T*>(C->data),
-                           stride_C_only, stride_C_AC, stride_C_BC, stride_C_ABC);
+            parallelize_if(internal::scale<T>, comm, get_config(cfg),
+                           len_C_all, beta, C->conj, data_C, stride_C_all);
         }
+    }
+    else
+    {
+        parallelize_if(internal::mult_sum<T>, comm, get_config(cfg),
+                       len_AB, len_AC, len_BC,
+                       alpha, conj_A, data_A, stride_A_AB, stride_A_AC,
+                              conj_B, data_B, stride_B_AB, stride_B_BC,
+                       beta, C->conj, data_C, stride_C_AC, stride_C_BC);
+    }
+
+    C->alpha<T>() = T(1);
+    C->conj = false;
+
+    return true;
+}
+
+extern "C"
+{
+
+void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
+                       const tblis_tensor* A, const label_type* idx_A,
+                       const tblis_tensor* B, const label_type* idx_B,
+                             tblis_tensor* C, const label_type* idx_C)
+{
+    tblis_tensor_mult_epilogue(comm, cfg, A, idx_A, B, idx_B, C, idx_C, nullptr);
+}
+
+void tblis_tensor_mult_epilogue(const tblis_comm* comm, const tblis_config* cfg,
+                                const tblis_tensor* A, const label_type* idx_A,
+                                const tblis_tensor* B, const label_type* idx_B,
+                                      tblis_tensor* C, const label_type* idx_C,
+                                const tblis_epilogue* epilogue)
+{
+    tblis_tensor_mult_plan plan;
+    init_mult_plan(plan, A, idx_A, B, idx_B, C, idx_C);
+    if (epilogue) plan.epilogue = *epilogue;
+
+    TBLIS_WITH_TYPE_AS(A->type, T,
+    {
+        execute_mult_plan(comm, cfg, plan,
+                          A->alpha<T>()*B->alpha<T>(),
+                          static_cast<const T*>(A->data),
+                          static_cast<const T*>(B->data),
+                          C->alpha<T>(), static_cast<T*>(C->data));
 
         C->alpha<T>() = T(1);
         C->conj = false;
     })
 }
 
+tblis_tensor_mult_plan* tblis_tensor_mult_plan_create(const tblis_tensor* A, const label_type* idx_A,
+                                                      const tblis_tensor* B, const label_type* idx_B,
+                                                      const tblis_tensor* C, const label_type* idx_C)
+{
+    tblis_tensor_mult_plan* plan = new tblis_tensor_mult_plan;
+    init_mult_plan(*plan, A, idx_A, B, idx_B, C, idx_C);
+    plan->keep = true;
+    return plan;
+}
+
+void tblis_tensor_mult_plan_destroy(tblis_tensor_mult_plan* plan)
+{
+    delete plan;
+}
+
+void tblis_tensor_mult_plan_set_impl(tblis_tensor_mult_plan* plan, impl_t impl)
+{
+    std::lock_guard<std::mutex> guard(plan->cache_lock);
+    plan->impl = impl;
+    plan->selected_impl.store(impl, std::memory_order_relaxed);
+    plan->cache_revision = 0;
+    plan->cache_layout.reset();
+}
+
+impl_t tblis_tensor_mult_plan_get_impl(const tblis_tensor_mult_plan* plan)
+{
+    return plan->selected_impl.load(std::memory_order_relaxed);
+}
+
+void tblis_tensor_mult_plan_set_epilogue(tblis_tensor_mult_plan* plan,
+                                         const tblis_epilogue* epilogue)
+{
+    if (epilogue)
+    {
+        plan->epilogue = *epilogue;
+    }
+    else
+    {
+        plan->epilogue.func = nullptr;
+        plan->epilogue.data = nullptr;
+    }
+}
+
+void tblis_tensor_mult_execute(const tblis_comm* comm, const tblis_config* cfg,
+                               const tblis_tensor_mult_plan* plan,
+                               const tblis_scalar* alpha, const void* A,
+                                                          const void* B,
+                               const tblis_scalar* beta,        void* C)
+{
+    TBLIS_ASSERT(alpha->type == plan->type);
+    TBLIS_ASSERT(beta->type == plan->type);
+
+    TBLIS_WITH_TYPE_AS(plan->type, T,
+    {
+        execute_mult_plan(comm, cfg, *plan,
+                          alpha->get<T>(), static_cast<const T*>(A),
+                                           static_cast<const T*>(B),
+                           beta->get<T>(),       static_cast<T*>(C));
+    })
+}
+
+void tblis_tensor_mult_sum(const tblis_comm* comm, const tblis_config* cfg,
+                           unsigned nterm,
+                           const tblis_tensor* const* A, const label_type* const* idx_A,
+                           const tblis_tensor* const* B, const label_type* const* idx_B,
+                                 tblis_tensor* C, const label_type* idx_C)
+{
+    TBLIS_WITH_TYPE_AS(C->type, T,
+    {
+        if (mult_sum<T>(comm, cfg, nterm, A, idx_A, B, idx_B, C, idx_C))
+            return;
+    })
+
+    /*
+     * Otherwise, compute the terms one at a time. C is scaled by the first
+     * term only, since tblis_tensor_mult resets the scaling of C.
+     */
+    for (unsigned i = 0;i < nterm;i++)
+        tblis_tensor_mult(comm, cfg, A[i], idx_A[i], B[i], idx_B[i], C, idx_C);
+}
+
 }
 
 }
@@ -19,6 +19,70 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
                        const tblis_tensor* B, const label_type* idx_B,
                              tblis_tensor* C, const label_type* idx_C);
 
+/*
+ * As tblis_tensor_mult, but also apply an epilogue to each element of C once
+ * its final value has been computed. When possible, this is done while each
+ * block of C is still in cache rather than in a separate pass over C.
+ * Elements of C may be processed in any order and by any thread.
+ */
+void tblis_tensor_mult_epilogue(const tblis_comm* comm, const tblis_config* cfg,
+                                const tblis_tensor* A, const label_type* idx_A,
+                                const tblis_tensor* B, const label_type* idx_B,
+                                      tblis_tensor* C, const label_type* idx_C,
+                                const tblis_epilogue* epilogue);
+
+/*
+ * A contraction plan captures the index analysis for a fixed set of lengths,
+ * strides, labels, conjugation flags, and data type, so that repeated
+ * contractions of the same shape only need new data pointers and scalars.
+ */
+typedef struct tblis_tensor_mult_plan tblis_tensor_mult_plan;
+
+tblis_tensor_mult_plan* tblis_tensor_mult_plan_create(const tblis_tensor* A, const label_type* idx_A,
+                                                      const tblis_tensor* B, const label_type* idx_B,
+                                                      const tblis_tensor* C, const label_type* idx_C);
+
+void tblis_tensor_mult_plan_destroy(tblis_tensor_mult_plan* plan);
+
+/*
+ * Request a particular implementation for this plan, overriding the
+ * library-wide default (AUTOMATIC, which chooses one based on a cost model).
+ * tblis_tensor_mult_plan_get_impl returns the implementation actually used by
+ * the most recent execution of the plan. A plan may be executed by several
+ * threads at once.
+ */
+void tblis_tensor_mult_plan_set_impl(tblis_tensor_mult_plan* plan, impl_t impl);
+
+impl_t tblis_tensor_mult_plan_get_impl(const tblis_tensor_mult_plan* plan);
+
+/*
+ * Apply an epilogue when executing this plan, as in
+ * tblis_tensor_mult_epilogue. The epilogue is copied, but its data is not.
+ * Passing NULL removes any epilogue.
+ */
+void tblis_tensor_mult_plan_set_epilogue(tblis_tensor_mult_plan* plan,
+                                         const tblis_epilogue* epilogue);
+
+void tblis_tensor_mult_execute(const tblis_comm* comm, const tblis_config* cfg,
+                               const tblis_tensor_mult_plan* plan,
+                               const tblis_scalar* alpha, const void* A,
+                                                          const void* B,
+                               const tblis_scalar* beta,        void* C);
+
+/*
+ * C = C + sum_i A_i*B_i, where the scaling factors and conjugation flags of
+ * each tensor are applied as in tblis_tensor_mult. If every term contracts
+ * over indices shared by A_i and B_i only, and the indices of C are divided
+ * among A_i and B_i in the same way for every term, then the terms are
+ * computed together in a single pass over C. Otherwise, they are computed
+ * one at a time. If there are no terms, then C is only scaled.
+ */
+void tblis_tensor_mult_sum(const tblis_comm* comm, const tblis_config* cfg,
+                           unsigned nterm,
+                           const tblis_tensor* const* A, const label_type* const* idx_A,
+                           const tblis_tensor* const* B, const label_type* const* idx_B,
+                                 tblis_tensor* C, const label_type* idx_C);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,6 +127,149 @@ void mult(const communicator& comm,
     tblis_tensor_mult(comm, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C);
 }
 
+/*
+ * C = epilogue(alpha*A*B + beta*C), where f(c) is called with a reference to
+ * each element c of C.
+ */
+template <typename T, typename Func>
+void mult_epilogue(T alpha, const_tensor_view<T> A, const label_type* idx_A,
+                            const_tensor_view<T> B, const label_type* idx_B,
+                   T  beta,       tensor_view<T> C, const label_type* idx_C,
+                   Func f)
+{
+    tblis_tensor A_s(alpha, A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(beta, C);
+
+    tblis_epilogue epilogue;
+    epilogue.func = [](void* data, void* c)
+    {
+        (*static_cast<Func*>(data))(*static_cast<T*>(c));
+    };
+    epilogue.data = &f;
+
+    tblis_tensor_mult_epilogue(nullptr, nullptr, &A_s, idx_A, &B_s, idx_B,
+                               &C_s, idx_C, &epilogue);
+}
+
+/*
+ * As mult_epilogue, but f(c, pos) is also passed the position of c in C, as
+ * an array with one entry per dimension of C. The position is recovered
+ * from the address of c, so the strides of C must be non-negative and
+ * nested: in order of increasing stride, each stride must be larger than
+ * the largest offset reachable along the dimensions before it. This is the
+ * case for any dense layout and any view of one, but not for e.g. lengths
+ * {2,3} with strides {3,2}.
+ */
+template <typename T, typename Func>
+void mult_epilogue_indexed(T alpha, const_tensor_view<T> A, const label_type* idx_A,
+                                    const_tensor_view<T> B, const label_type* idx_B,
+                           T  beta,       tensor_view<T> C, const label_type* idx_C,
+                           Func f)
+{
+    struct closure
+    {
+        Func& f;
+        const tensor_view<T>& C;
+        std::vector<unsigned> order;
+    } cl{f, C, {}};
+
+    for (unsigned i = 0;i < C.dimension();i++)
+    {
+        TBLIS_ASSERT(C.stride(i) >= 0);
+        if (C.length(i) > 1) cl.order.push_back(i);
+    }
+
+    std::sort(cl.order.begin(), cl.order.end(),
+              [&](unsigned i, unsigned j) { return C.stride(i) > C.stride(j); });
+
+    stride_type extent = 0;
+    for (auto it = cl.order.rbegin();it != cl.order.rend();++it)
+    {
+        TBLIS_ASSERT(C.stride(*it) > extent);
+        extent += C.stride(*it)*(C.length(*it)-1);
+    }
+
+    tblis_epilogue epilogue;
+    epilogue.func = [](void* data, void* c)
+    {
+        auto& cl = *static_cast<closure*>(data);
+
+        /*
+         * Avoid allocating for each element in the common case.
+         */
+        len_type pos_local[16];
+        std::vector<len_type> pos_heap;
+        len_type* pos = pos_local;
+        if (cl.C.dimension() > 16)
+        {
+            pos_heap.resize(cl.C.dimension());
+            pos = pos_heap.data();
+        }
+        std::fill_n(pos, cl.C.dimension(), 0);
+
+        stride_type off = static_cast<T*>(c) - cl.C.data();
+
+        for (auto i : cl.order)
+        {
+            pos[i] = off/cl.C.stride(i);
+            off -= pos[i]*cl.C.stride(i);
+        }
+
+        cl.f(*static_cast<T*>(c), pos);
+    };
+    epilogue.data = &cl;
+
+    tblis_tensor A_s(alpha, A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(beta, C);
+
+    tblis_tensor_mult_epilogue(nullptr, nullptr, &A_s, idx_A, &B_s, idx_B,
+                               &C_s, idx_C, &epilogue);
+}
+
+template <typename T>
+tblis_tensor_mult_plan* mult_plan(const_tensor_view<T> A, const label_type* idx_A,
+                                  const_tensor_view<T> B, const label_type* idx_B,
+                                  const_tensor_view<T> C, const label_type* idx_C)
+{
+    tblis_tensor A_s(A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(C);
+
+    return tblis_tensor_mult_plan_create(&A_s, idx_A, &B_s, idx_B, &C_s, idx_C);
+}
+
+template <typename T>
+void mult(const tblis_tensor_mult_plan* plan,
+          T alpha, const T* A, const T* B, T beta, T* C)
+{
+    tblis_scalar alpha_s(alpha);
+    tblis_scalar beta_s(beta);
+
+    tblis_tensor_mult_execute(nullptr, nullptr, plan, &alpha_s, A, B, &beta_s, C);
+}
+
+template <typename T>
+void mult(single_t, const tblis_tensor_mult_plan* plan,
+          T alpha, const T* A, const T* B, T beta, T* C)
+{
+    tblis_scalar alpha_s(alpha);
+    tblis_scalar beta_s(beta);
+
+    tblis_tensor_mult_execute(tblis_single, nullptr, plan, &alpha_s, A, B, &beta_s, C);
+}
+
+template <typename T>
+void mult(const communicator& comm, const tblis_tensor_mult_plan* plan,
+          T alpha, const T* A, const T* B, T beta, T* C)
+{
+    tblis_scalar alpha_s(alpha);
+    tblis_scalar beta_s(beta);
+
+    tblis_tensor_mult_execute(comm, nullptr, plan, &alpha_s, A, B, &beta_s, C);
+}
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,346 @@
+#include "network.h"
+#include "mult.h"
+
+#include "util/macros.h"
+#include "util/tensor.hpp"
+#include "memory/memory_pool.hpp"
+#include "iface/1t/add.h"
+
+namespace tblis
+{
+
+MemoryPool BuffersForNetwork(4096);
+
+/*
+ * Above this number of tensors, fall back from an exhaustive search over
+ * contraction orders (O(3^n)) to a greedy one.
+ */
+static constexpr unsigned network_max_optimal = 10;
+
+namespace
+{
+
+struct network_path
+{
+    std::vector<std::vector<label_type>> idx_A;
+    std::vector<label_type> idx_C;
+    std::vector<std::pair<label_type,len_type>> lengths;
+    std::vector<std::pair<unsigned,unsigned>> path;
+
+    network_path(const std::vector<std::vector<label_type>>& idx_A_,
+                 const std::vector<label_type>& idx_C_,
+                 const std::vector<std::pair<label_type,len_type>>& lengths_)
+    : idx_A(idx_A_), idx_C(stl_ext::uniqued(idx_C_)), lengths(lengths_)
+    {
+        for (auto& idx : idx_A) stl_ext::unique(idx);
+
+        if (idx_A.size() <= network_max_optimal)
+        {
+            optimal();
+        }
+        else
+        {
+            greedy();
+        }
+    }
+
+    /*
+     * The number of elements spanned by a set of indices.
+     */
+    double size(const std::vector<label_type>& idx) const
+    {
+        double s = 1;
+
+        for (auto i : idx)
+        {
+            for (auto& l : lengths)
+            {
+                if (l.first == i)
+                {
+                    s *= l.second;
+                    break;
+                }
+            }
+        }
+
+        return s;
+    }
+
+    /*
+     * Search over all ways of splitting each subset of the tensors into two,
+     * starting from the smallest subsets.
+     */
+    void optimal()
+    {
+        unsigned n = idx_A.size();
+        unsigned full = (1u << n) - 1;
+
+        std::vector<std::vector<label_type>> idx(full+1), kept(full+1);
+        std::vector<double> cost(full+1, 0.0);
+        std::vector<unsigned> split(full+1, 0);
+
+        for (unsigned mask = 1;mask <= full;mask++)
+        {
+            unsigned i = __builtin_ctz(mask);
+            idx[mask] = stl_ext::uniqued(idx[mask & (mask-1)] + idx_A[i]);
+        }
+
+        for (unsigned mask = 1;mask <= full;mask++)
+        {
+            kept[mask] = stl_ext::intersection(idx[mask],
+                stl_ext::uniqued(idx[full ^ mask] + idx_C));
+        }
+
+        for (unsigned mask = 1;mask <= full;mask++)
+        {
+            if ((mask & (mask-1)) == 0) continue;
+
+            cost[mask] = std::numeric_limits<double>::max();
+
+            for (unsigned sub = (mask-1) & mask;sub > 0;sub = (sub-1) & mask)
+            {
+                unsigned rest = mask ^ sub;
+                if (sub < rest) continue;
+
+                double c = cost[sub] + cost[rest] +
+                    size(stl_ext::uniqued(kept[sub] + kept[rest]));
+
+                if (c < cost[mask])
+                {
+                    cost[mask] = c;
+                    split[mask] = sub;
+                }
+            }
+        }
+
+        if (n > 1) add_steps(split, full);
+    }
+
+    unsigned add_steps(const std::vector<unsigned>& split, unsigned mask)
+    {
+        if ((mask & (mask-1)) == 0) return __builtin_ctz(mask);
+
+        unsigned left = add_steps(split, split[mask]);
+        unsigned right = add_steps(split, mask ^ split[mask]);
+        path.emplace_back(left, right);
+
+        return idx_A.size() + path.size() - 1;
+    }
+
+    /*
+     * Repeatedly perform the cheapest pairwise contraction among the
+     * remaining operands.
+     */
+    void greedy()
+    {
+        std::vector<std::pair<unsigned,std::vector<label_type>>> ops;
+        for (unsigned i = 0;i < idx_A.size();i++) ops.emplace_back(i, idx_A[i]);
+
+        while (ops.size() > 1)
+        {
+            double best_cost = std::numeric_limits<double>::max();
+            double best_size = std::numeric_limits<double>::max();
+            unsigned best_i = 0, best_j = 1;
+            std::vector<label_type> best_idx;
+
+            for (unsigned i = 0;i < ops.size();i++)
+            {
+                for (unsigned j = i+1;j < ops.size();j++)
+                {
+                    auto idx = idx_C;
+                    for (unsigned k = 0;k < ops.size();k++)
+                        if (k != i && k != j) idx += ops[k].second;
+
+                    auto idx_ij = stl_ext::uniqued(ops[i].second + ops[j].second);
+                    auto kept = stl_ext::intersection(idx_ij, stl_ext::uniqued(idx));
+
+                    double c = size(idx_ij);
+                    double s = size(kept);
+
+                    if (c < best_cost || (c == best_cost && s < best_size))
+                    {
+                        best_cost = c;
+                        best_size = s;
+                        best_i = i;
+                        best_j = j;
+                        best_idx = kept;
+                    }
+                }
+            }
+
+            path.emplace_back(ops[best_i].first, ops[best_j].first);
+            ops.erase(ops.begin()+best_j);
+            ops.erase(ops.begin()+best_i);
+            ops.emplace_back(idx_A.size() + path.size() - 1, best_idx);
+        }
+    }
+};
+
+template <typename T>
+struct network_operand
+{
+    tblis_tensor tensor;
+    std::vector<label_type> idx;
+    std::vector<len_type> len;
+    std::vector<stride_type> stride;
+    MemoryPool::Block data;
+};
+
+template <typename T>
+void contract_network(const tblis_comm* comm, const tblis_config* cfg,
+                      unsigned ntensor,
+                      const tblis_tensor* const* A, const label_type* const* idx_A,
+                            tblis_tensor* C, const label_type* idx_C_)
+{
+    std::vector<std::vector<label_type>> idx(ntensor);
+    std::vector<std::pair<label_type,len_type>> lengths;
+
+    auto add_lengths = [&](const tblis_tensor* A, const label_type* idx_A)
+    {
+        for (unsigned i = 0;i < A->ndim;i++)
+        {
+            bool found = false;
+            for (auto& l : lengths)
+            {
+                if (l.first == idx_A[i])
+                {
+                    TBLIS_ASSERT(l.second == A->len[i]);
+                    found = true;
+                }
+            }
+            if (!found) lengths.emplace_back(idx_A[i], A->len[i]);
+        }
+    };
+
+    for (unsigned i = 0;i < ntensor;i++)
+    {
+        TBLIS_ASSERT(A[i]->type == C->type);
+        idx[i].assign(idx_A[i], idx_A[i]+A[i]->ndim);
+        add_lengths(A[i], idx_A[i]);
+    }
+
+    std::vector<label_type> idx_C(idx_C_, idx_C_+C->ndim);
+    add_lengths(C, idx_C_);
+
+    network_path p(idx, idx_C, lengths);
+
+    std::vector<network_operand<T>> ops(ntensor + p.path.size());
+
+    for (unsigned i = 0;i < ntensor;i++)
+    {
+        ops[i].tensor = *A[i];
+        ops[i].idx = idx[i];
+    }
+
+    auto comm_ = reinterpret_cast<const communicator*>(comm);
+
+    for (unsigned step = 0;step < p.path.size();step++)
+    {
+        auto& left = ops[p.path[step].first];
+        auto& right = ops[p.path[step].second];
+
+        if (step == p.path.size()-1)
+        {
+            tblis_tensor_mult(comm, cfg, &left.tensor, left.idx.data(),
+                                         &right.tensor, right.idx.data(),
+                                         C, idx_C_);
+            break;
+        }
+
+        /*
+         * The result keeps the indices which are still needed by the
+         * remaining operands or by C.
+         */
+        auto needed = idx_C;
+        for (unsigned i = 0;i < ntensor+step;i++)
+            if (ops[i].tensor.data && &ops[i] != &left && &ops[i] != &right)
+                needed += ops[i].idx;
+
+        auto& result = ops[ntensor+step];
+        result.idx = stl_ext::intersection(stl_ext::uniqued(left.idx + right.idx),
+                                           stl_ext::uniqued(needed));
+
+        stride_type size = 1;
+        for (auto i : result.idx)
+        {
+            for (auto& l : lengths)
+            {
+                if (l.first == i)
+                {
+                    result.len.push_back(l.second);
+                    result.stride.push_back(size);
+                    size *= l.second;
+                    break;
+                }
+            }
+        }
+
+        T* data = nullptr;
+
+        if (!comm || comm_->master())
+        {
+            result.data = BuffersForNetwork.allocate<T>(size);
+            data = result.data.template get<T>();
+        }
+
+        if (comm) comm_->broadcast(data);
+
+        result.tensor.type = type_tag<T>::value;
+        result.tensor.conj = false;
+        result.tensor.scalar = tblis_scalar(T(0));
+        result.tensor.data = data;
+        result.tensor.ndim = result.idx.size();
+        result.tensor.len = result.len.data();
+        result.tensor.stride = result.stride.data();
+
+        tblis_tensor_mult(comm, cfg, &left.tensor, left.idx.data(),
+                                     &right.tensor, right.idx.data(),
+                                     &result.tensor, result.idx.data());
+
+        /*
+         * Intermediates are returned to the pool as soon as they have been
+         * used, so that later intermediates can reuse the same memory.
+         */
+        if (comm) comm_->barrier();
+
+        left.tensor.data = right.tensor.data = nullptr;
+        left.data = MemoryPool::Block();
+        right.data = MemoryPool::Block();
+    }
+}
+
+}
+
+std::vector<std::pair<unsigned,unsigned>>
+contract_network_path(const std::vector<std::vector<label_type>>& idx_A,
+                      const std::vector<label_type>& idx_C,
+                      const std::vector<std::pair<label_type,len_type>>& lengths)
+{
+    return network_path(idx_A, idx_C, lengths).path;
+}
+
+extern "C"
+{
+
+void tblis_tensor_contract_network(const tblis_comm* comm, const tblis_config* cfg,
+                                   unsigned ntensor,
+                                   const tblis_tensor* const* A, const label_type* const* idx_A,
+                                         tblis_tensor* C, const label_type* idx_C)
+{
+    TBLIS_ASSERT(ntensor > 0);
+
+    if (ntensor == 1)
+    {
+        tblis_tensor_add(comm, cfg, A[0], idx_A[0], C, idx_C);
+        return;
+    }
+
+    TBLIS_WITH_TYPE_AS(C->type, T,
+    {
+        contract_network<T>(comm, cfg, ntensor, A, idx_A, C, idx_C);
+    })
+}
+
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef _TBLIS_IFACE_3T_NETWORK_H_
+#define _TBLIS_IFACE_3T_NETWORK_H_
+
+#include "../../util/thread.h"
+#include "../../util/basic_types.h"
+
+#ifdef __cplusplus
+
+namespace tblis
+{
+
+extern "C"
+{
+
+#endif
+
+/*
+ * Contract a network of tensors, einsum-style: every index which appears in
+ * C is kept and every other index is summed over, i.e.
+ *
+ *   C = alpha_C*C + (alpha_A[0]*A[0]) * (alpha_A[1]*A[1]) * ...
+ *
+ * The network is contracted as a sequence of pairwise contractions, in an
+ * order chosen to minimize the total number of operations. Intermediate
+ * tensors are allocated from a pool which is reused between calls.
+ */
+void tblis_tensor_contract_network(const tblis_comm* comm, const tblis_config* cfg,
+                                   unsigned ntensor,
+                                   const tblis_tensor* const* A, const label_type* const* idx_A,
+                                         tblis_tensor* C, const label_type* idx_C);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
+
+/*
+ * The pairwise contraction order used by tblis_tensor_contract_network. Each
+ * step contracts two operands, which are removed, and appends the result as a
+ * new operand: the initial operands are numbered 0...ntensor-1 and the result
+ * of step i is numbered ntensor+i.
+ */
+std::vector<std::pair<unsigned,unsigned>>
+contract_network_path(const std::vector<std::vector<label_type>>& idx_A,
+                      const std::vector<label_type>& idx_C,
+                      const std::vector<std::pair<label_type,len_type>>& lengths);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
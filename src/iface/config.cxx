@@ -0,0 +1,171 @@
+#include "config.h"
+
+#include "configs/configs.hpp"
+
+namespace tblis
+{
+
+namespace
+{
+
+/*
+ * The configuration is about to be modified, so give it a new revision.
+ */
+config& get_mutable_config(tblis_config* cfg)
+{
+    TBLIS_ASSERT(cfg);
+    config& c = *reinterpret_cast<config*>(cfg);
+    c.revision = next_config_revision();
+    return c;
+}
+
+blocksize config::* const blocksizes[] =
+{
+    &config::gemm_mc,
+    &config::gemm_nc,
+    &config::gemm_kc
+};
+
+parameter<unsigned> config::* const unsigned_parameters[] =
+{
+    &config::m_thread_ratio,
+    &config::n_thread_ratio,
+    &config::mr_max_thread,
+    &config::nr_max_thread
+};
+
+parameter<bool> config::* const bool_parameters[] =
+{
+    &config::gemm_row_major,
+    &config::trans_row_major,
+    &config::dynamic_partition
+};
+
+/*
+ * Every micro-kernel is stored as an array of type-erased function pointers,
+ * so any of them may be set through a reference to this one member.
+ */
+void (*(&get_kernel(config& cfg, tblis_kernel_t ker))[4])(void)
+{
+    switch (ker)
+    {
+        case TBLIS_ADD_UKR:        return cfg.add_ukr._ukr;
+        case TBLIS_COPY_UKR:       return cfg.copy_ukr._ukr;
+        case TBLIS_DOT_UKR:        return cfg.dot_ukr._ukr;
+        case TBLIS_REDUCE_UKR:     return cfg.reduce_ukr._ukr;
+        case TBLIS_SCALE_UKR:      return cfg.scale_ukr._ukr;
+        case TBLIS_SET_UKR:        return cfg.set_ukr._ukr;
+        case TBLIS_TRANS_ADD_UKR:  return cfg.trans_add_ukr._ukr;
+        case TBLIS_TRANS_COPY_UKR: return cfg.trans_copy_ukr._ukr;
+        case TBLIS_GEMM_UKR:       return cfg.gemm_ukr._ukr;
+        case TBLIS_UPDATE_NN_UKR:  return cfg.update_nn_ukr._ukr;
+        case TBLIS_UPDATE_SN_UKR:  return cfg.update_sn_ukr._ukr;
+        case TBLIS_UPDATE_NS_UKR:  return cfg.update_ns_ukr._ukr;
+        case TBLIS_UPDATE_SS_UKR:  return cfg.update_ss_ukr._ukr;
+        case TBLIS_PACK_NN_MR_UKR: return cfg.pack_nn_mr_ukr._ukr;
+        case TBLIS_PACK_NN_NR_UKR: return cfg.pack_nn_nr_ukr._ukr;
+        case TBLIS_PACK_SN_MR_UKR: return cfg.pack_sn_mr_ukr._ukr;
+        case TBLIS_PACK_SN_NR_UKR: return cfg.pack_sn_nr_ukr._ukr;
+        case TBLIS_PACK_NS_MR_UKR: return cfg.pack_ns_mr_ukr._ukr;
+        case TBLIS_PACK_NS_NR_UKR: return cfg.pack_ns_nr_ukr._ukr;
+        case TBLIS_PACK_SS_MR_UKR: return cfg.pack_ss_mr_ukr._ukr;
+        case TBLIS_PACK_SS_NR_UKR: return cfg.pack_ss_nr_ukr._ukr;
+        case TBLIS_PACK_NB_MR_UKR: return cfg.pack_nb_mr_ukr._ukr;
+        case TBLIS_PACK_NB_NR_UKR: return cfg.pack_nb_nr_ukr._ukr;
+        case TBLIS_PACK_SB_MR_UKR: return cfg.pack_sb_mr_ukr._ukr;
+        case TBLIS_PACK_SB_NR_UKR: return cfg.pack_sb_nr_ukr._ukr;
+    }
+
+    tblis_abort_with_message(nullptr, "tblis: Unknown kernel %d", (int)ker);
+}
+
+}
+
+extern "C"
+{
+
+const tblis_config* tblis_get_config(const char* name)
+{
+    const config* cfg = (name ? find_config(name) : &get_default_config());
+    return reinterpret_cast<const tblis_config*>(cfg);
+}
+
+tblis_config* tblis_clone_config(const tblis_config* cfg)
+{
+    config* c = new config(get_config(cfg));
+    c->revision = next_config_revision();
+    return reinterpret_cast<tblis_config*>(c);
+}
+
+void tblis_free_config(tblis_config* cfg)
+{
+    delete reinterpret_cast<config*>(cfg);
+}
+
+const char* tblis_config_name(const tblis_config* cfg)
+{
+    return get_config(cfg).name;
+}
+
+void tblis_config_set_blocksize(tblis_config* cfg, tblis_blocksize_t bs,
+                                type_t type, len_type def, len_type max)
+{
+    TBLIS_ASSERT(bs >= TBLIS_GEMM_MC && bs <= TBLIS_GEMM_KC);
+    TBLIS_ASSERT(type >= TYPE_SINGLE && type <= TYPE_DCOMPLEX);
+
+    blocksize& B = get_mutable_config(cfg).*blocksizes[bs];
+
+    TBLIS_ASSERT(def > 0 && def%B._iota[type] == 0);
+    TBLIS_ASSERT(max >= def);
+
+    B._def[type] = def;
+    B._max[type] = max;
+    B._extent[type] = def;
+}
+
+void tblis_config_set_parameter(tblis_config* cfg, tblis_parameter_t param,
+                                type_t type, unsigned value)
+{
+    TBLIS_ASSERT(type >= TYPE_SINGLE && type <= TYPE_DCOMPLEX);
+
+    config& c = get_mutable_config(cfg);
+
+    switch (param)
+    {
+        case TBLIS_M_THREAD_RATIO:
+        case TBLIS_N_THREAD_RATIO:
+        case TBLIS_MR_MAX_THREAD:
+        case TBLIS_NR_MAX_THREAD:
+            TBLIS_ASSERT(value > 0);
+            (c.*unsigned_parameters[param-TBLIS_M_THREAD_RATIO])._val[type] = value;
+            break;
+        case TBLIS_GEMM_ROW_MAJOR:
+        case TBLIS_TRANS_ROW_MAJOR:
+        case TBLIS_DYNAMIC_PARTITION:
+            /*
+             * The packed layout of 1m micro-panels is fixed by the real
+             * kernel, so it cannot be changed at runtime.
+             */
+            if (param == TBLIS_GEMM_ROW_MAJOR && c.gemm_1m._val[type] &&
+                c.gemm_row_major._val[type] != bool(value))
+                tblis_abort_with_message(nullptr, "tblis: Cannot change the gemm "
+                                         "layout of a type which uses the 1m method");
+            (c.*bool_parameters[param-TBLIS_GEMM_ROW_MAJOR])._val[type] = value;
+            break;
+        default:
+            tblis_abort_with_message(nullptr, "tblis: Unknown parameter %d", (int)param);
+    }
+}
+
+void tblis_config_set_kernel(tblis_config* cfg, tblis_kernel_t ker,
+                             type_t type, void (*ukr)(void))
+{
+    TBLIS_ASSERT(type >= TYPE_SINGLE && type <= TYPE_DCOMPLEX);
+    TBLIS_ASSERT(ukr);
+
+    get_kernel(get_mutable_config(cfg), ker)[type] = ukr;
+}
+
+}
+
+}
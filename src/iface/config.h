@@ -0,0 +1,116 @@
+#ifndef _TBLIS_IFACE_CONFIG_H_
+#define _TBLIS_IFACE_CONFIG_H_
+
+#include "../util/basic_types.h"
+
+#ifdef __cplusplus
+
+namespace tblis
+{
+
+extern "C"
+{
+
+#endif
+
+typedef enum
+{
+    TBLIS_GEMM_MC = 0,
+    TBLIS_GEMM_NC = 1,
+    TBLIS_GEMM_KC = 2
+} tblis_blocksize_t;
+
+typedef enum
+{
+    TBLIS_M_THREAD_RATIO    = 0,
+    TBLIS_N_THREAD_RATIO    = 1,
+    TBLIS_MR_MAX_THREAD     = 2,
+    TBLIS_NR_MAX_THREAD     = 3,
+    TBLIS_GEMM_ROW_MAJOR    = 4,
+    TBLIS_TRANS_ROW_MAJOR   = 5,
+    TBLIS_DYNAMIC_PARTITION = 6
+} tblis_parameter_t;
+
+typedef enum
+{
+    TBLIS_ADD_UKR        =  0,
+    TBLIS_COPY_UKR       =  1,
+    TBLIS_DOT_UKR        =  2,
+    TBLIS_REDUCE_UKR     =  3,
+    TBLIS_SCALE_UKR      =  4,
+    TBLIS_SET_UKR        =  5,
+    TBLIS_TRANS_ADD_UKR  =  6,
+    TBLIS_TRANS_COPY_UKR =  7,
+    TBLIS_GEMM_UKR       =  8,
+    TBLIS_UPDATE_NN_UKR  =  9,
+    TBLIS_UPDATE_SN_UKR  = 10,
+    TBLIS_UPDATE_NS_UKR  = 11,
+    TBLIS_UPDATE_SS_UKR  = 12,
+    TBLIS_PACK_NN_MR_UKR = 13,
+    TBLIS_PACK_NN_NR_UKR = 14,
+    TBLIS_PACK_SN_MR_UKR = 15,
+    TBLIS_PACK_SN_NR_UKR = 16,
+    TBLIS_PACK_NS_MR_UKR = 17,
+    TBLIS_PACK_NS_NR_UKR = 18,
+    TBLIS_PACK_SS_MR_UKR = 19,
+    TBLIS_PACK_SS_NR_UKR = 20,
+    TBLIS_PACK_NB_MR_UKR = 21,
+    TBLIS_PACK_NB_NR_UKR = 22,
+    TBLIS_PACK_SB_MR_UKR = 23,
+    TBLIS_PACK_SB_NR_UKR = 24
+} tblis_kernel_t;
+
+/*
+ * Return the configuration with the given name, or the default configuration
+ * if name is NULL. Returns NULL if there is no such configuration or it
+ * cannot run on this hardware.
+ */
+const tblis_config* tblis_get_config(const char* name);
+
+/*
+ * Return a modifiable copy of the given configuration (or of the default
+ * configuration if cfg is NULL). The copy keeps the name of the original, so
+ * tuning data for the original also applies to it. It must be freed with
+ * tblis_free_config.
+ */
+tblis_config* tblis_clone_config(const tblis_config* cfg);
+
+void tblis_free_config(tblis_config* cfg);
+
+const char* tblis_config_name(const tblis_config* cfg);
+
+/*
+ * Set a gemm cache blocksize for one data type. The default blocksize must be
+ * a positive multiple of the corresponding register blocksize, and the
+ * maximum blocksize (which may absorb a small remainder) must not be smaller
+ * than the default.
+ */
+void tblis_config_set_blocksize(tblis_config* cfg, tblis_blocksize_t bs,
+                                type_t type, len_type def, len_type max);
+
+/*
+ * Set a parameter for one data type. The row-major and dynamic partitioning
+ * flags are booleans, and the rest are positive integers. The gemm layout of
+ * a type which uses the 1m method (complex types on some configurations)
+ * cannot be changed.
+ */
+void tblis_config_set_parameter(tblis_config* cfg, tblis_parameter_t param,
+                                type_t type, unsigned value);
+
+/*
+ * Replace a micro-kernel for one data type. The kernel must have the
+ * signature of the corresponding kernel type (e.g. gemm_ukr_t<T>), and must
+ * use the same register blocksizes as the kernel that it replaces.
+ */
+void tblis_config_set_kernel(tblis_config* cfg, tblis_kernel_t ker,
+                             type_t type, void (*ukr)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
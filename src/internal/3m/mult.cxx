@@ -6,14 +6,19 @@
 #include "nodes/packm.hpp"
 #include "nodes/gemm_ukr.hpp"
 
+#include "internal/1m/add.hpp"
+#include "internal/1m/scale.hpp"
+#include "internal/1m/set.hpp"
+
 namespace tblis
 {
 namespace internal
 {
 
-extern MemoryPool BuffersForA, BuffersForB;
+extern MemoryPool BuffersForA, BuffersForB, BuffersForC;
 MemoryPool BuffersForA(4096);
 MemoryPool BuffersForB(4096);
+MemoryPool BuffersForC(4096);
 
 using GotoGEMM = partition_gemm_nc<
                    partition_gemm_kc<
@@ -31,8 +36,6 @@ void mult(const communicator& comm, const config& cfg,
                    bool conj_B, const T* B, stride_type rs_B, stride_type cs_B,
           T  beta, bool conj_C,       T* C, stride_type rs_C, stride_type cs_C)
 {
-    TBLIS_ASSERT(!conj_A && !conj_B && !conj_C);
-
     const bool row_major = cfg.gemm_row_major.value<T>();
 
     if ((row_major ? rs_C : cs_C) == 1)
@@ -42,6 +45,7 @@ void mult(const communicator& comm, const config& cfg,
          */
         std::swap(m, n);
         std::swap(A, B);
+        std::swap(conj_A, conj_B);
         std::swap(rs_A, cs_B);
         std::swap(rs_B, cs_A);
         std::swap(rs_C, cs_C);
@@ -54,15 +58,88 @@ void mult(const communicator& comm, const config& cfg,
     GotoGEMM gemm;
 
     int nt = comm.num_threads();
-    gemm_thread_config tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
+    gemm_thread_config tc = make_gemm_thread_config<T>(cfg, nt, m, n, k, true);
     step<0>(gemm).distribute = tc.jc_nt;
     step<3>(gemm).distribute = tc.ic_nt;
     step<5>(gemm).distribute = tc.jr_nt;
     step<6>(gemm).distribute = tc.ir_nt;
 
-    gemm(comm, cfg, alpha, Av, Bv, beta, Cv);
+    step<2>(gemm).conj = conj_B;
+    step<4>(gemm).conj = conj_A;
+    leaf(gemm).conj_C = conj_C;
+
+    if (tc.pc_nt == 1)
+    {
+        gemm(comm, cfg, alpha, Av, Bv, beta, Cv);
+
+        comm.barrier();
+        return;
+    }
+
+    /*
+     * Split k between tc.pc_nt gangs. The first gang updates C directly, and
+     * the others each compute their part of the product into a private
+     * buffer (laid out the way the micro-kernel prefers), which are then
+     * added into C by all threads.
+     */
+    auto subcomm = comm.gang(TCI_EVENLY, tc.pc_nt);
+
+    len_type k_first, k_last;
+    std::tie(k_first, k_last, std::ignore) =
+        subcomm.distribute_over_gangs(k, cfg.gemm_kr.def<T>());
+
+    const stride_type rs_P = (row_major ? n : 1);
+    const stride_type cs_P = (row_major ? 1 : m);
+
+    MemoryPool::Block buffer;
+    T* P = nullptr;
+
+    if (comm.master())
+    {
+        buffer = BuffersForC.allocate<T>((tc.pc_nt-1)*m*n);
+        P = buffer.get<T>();
+    }
+
+    comm.broadcast(P);
+
+    Av.shift(1, k_first);
+    Av.length(1, k_last-k_first);
+    Bv.shift(0, k_first);
+    Bv.length(0, k_last-k_first);
+
+    /*
+     * If k is very short then some gangs may not get any of it.
+     */
+    if (subcomm.gang_num() == 0)
+    {
+        if (k_last > k_first)
+            gemm(subcomm, cfg, alpha, Av, Bv, beta, Cv);
+        else if (beta == T(0))
+            set(subcomm, cfg, m, n, T(0), C, rs_C, cs_C);
+        else
+            scale(subcomm, cfg, m, n, beta, conj_C, C, rs_C, cs_C);
+    }
+    else
+    {
+        T* P_gang = P + (subcomm.gang_num()-1)*m*n;
+
+        if (k_last > k_first)
+        {
+            matrix_view<T> Pv({m, n}, P_gang, {rs_P, cs_P});
+            leaf(gemm).conj_C = false;
+            gemm(subcomm, cfg, alpha, Av, Bv, T(0), Pv);
+        }
+        else
+        {
+            set(subcomm, cfg, m, n, T(0), P_gang, rs_P, cs_P);
+        }
+    }
 
     comm.barrier();
+
+    for (int gang = 1;gang < tc.pc_nt;gang++)
+        add(comm, cfg, m, n, T(1), false, P + (gang-1)*m*n, rs_P, cs_P,
+                             T(1), false, C, rs_C, cs_C);
 }
 
 #define FOREACH_TYPE(T) \
@@ -8,6 +8,8 @@
 #include "nodes/gemm_ukr.hpp"
 
 #include "internal/1t/add.hpp"
+#include "internal/1t/scale.hpp"
+#include "internal/1t/set.hpp"
 #include "internal/3m/mult.hpp"
 
 namespace tblis
@@ -15,9 +17,9 @@ namespace tblis
 namespace internal
 {
 
-impl_t impl = BLIS_BASED;
+impl_t impl = AUTOMATIC;
 
-extern MemoryPool BuffersForA, BuffersForB, BuffersForScatter;
+extern MemoryPool BuffersForA, BuffersForB, BuffersForC, BuffersForScatter;
 MemoryPool BuffersForScatter(4096);
 
 using TensorGEMM = partition_gemm_nc<
@@ -35,13 +37,13 @@ void contract_blas(const communicator& comm, const config& cfg,
                    const std::vector<len_type>& len_AB,
                    const std::vector<len_type>& len_AC,
                    const std::vector<len_type>& len_BC,
-                   T alpha, const T* A,
+                   T alpha, bool conj_A, const T* A,
                    const std::vector<stride_type>& stride_A_AB,
                    const std::vector<stride_type>& stride_A_AC,
-                            const T* B,
+                            bool conj_B, const T* B,
                    const std::vector<stride_type>& stride_B_AB,
                    const std::vector<stride_type>& stride_B_BC,
-                   T  beta,       T* C,
+                   T  beta, bool conj_C,       T* C,
                    const std::vector<stride_type>& stride_C_AC,
                    const std::vector<stride_type>& stride_C_BC)
 {
@@ -71,12 +73,12 @@ void contract_blas(const communicator& comm, const config& cfg,
     matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
 
     add(comm, cfg, {}, {}, arv.lengths(),
-        T(1), false,          A, {}, stride_A_AC+stride_A_AB,
-        T(0), false, arv.data(), {},           arv.strides());
+        T(1), conj_A,          A, {}, stride_A_AC+stride_A_AB,
+        T(0),  false, arv.data(), {},           arv.strides());
 
     add(comm, cfg, {}, {}, brv.lengths(),
-        T(1), false,          B, {}, stride_B_AB+stride_B_BC,
-        T(0), false, brv.data(), {},           brv.strides());
+        T(1), conj_B,          B, {}, stride_B_AB+stride_B_BC,
+        T(0),  false, brv.data(), {},           brv.strides());
 
     mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
          alpha, false, am.data(), am.stride(0), am.stride(1),
@@ -84,8 +86,8 @@ void contract_blas(const communicator& comm, const config& cfg,
           T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
     add(comm, cfg, {}, {}, crv.lengths(),
-        T(1), false, crv.data(), {},            crv.strides(),
-        beta, false,          C, {}, stride_C_AC+stride_C_BC);
+        T(1),  false, crv.data(), {},            crv.strides(),
+        beta, conj_C,          C, {}, stride_C_AC+stride_C_BC);
 }
 
 template <typename T>
@@ -93,13 +95,13 @@ void contract_ref(const communicator& comm, const config& cfg,
                   const std::vector<len_type>& len_AB,
                   const std::vector<len_type>& len_AC,
                   const std::vector<len_type>& len_BC,
-                  T alpha, const T* A,
+                  T alpha, bool conj_A, const T* A,
                   const std::vector<stride_type>& stride_A_AB,
                   const std::vector<stride_type>& stride_A_AC,
-                           const T* B,
+                           bool conj_B, const T* B,
                   const std::vector<stride_type>& stride_B_AB,
                   const std::vector<stride_type>& stride_B_BC,
-                  T  beta,       T* C,
+                  T  beta, bool conj_C,       T* C,
                   const std::vector<stride_type>& stride_C_AC,
                   const std::vector<stride_type>& stride_C_BC)
 {
@@ -139,7 +141,7 @@ void contract_ref(const communicator& comm, const config& cfg,
 
             while (iter_AB.next(A, B))
             {
-                temp += (*A)*(*B);
+                temp += conj(conj_A, *A)*conj(conj_B, *B);
             }
             temp *= alpha;
 
@@ -149,42 +151,324 @@ void contract_ref(const communicator& comm, const config& cfg,
             }
             else
             {
-                *C = temp + beta*(*C);
+                *C = temp + beta*conj(conj_C, *C);
             }
         }
     }
 }
 
+template <typename T>
+void apply_epilogue(const communicator& comm,
+                    const std::vector<len_type>& len,
+                    T* C, const std::vector<stride_type>& stride,
+                    const tblis_epilogue* epilogue)
+{
+    MArray::viterator<1> iter(len, stride);
+    len_type n = stl_ext::prod(len);
+
+    len_type n_min, n_max;
+    std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
+
+    iter.position(n_min, C);
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter.next(C);
+        epilogue->func(epilogue->data, C);
+    }
+
+    comm.barrier();
+}
+
 template <typename T>
 void contract_blis(const communicator& comm, const config& cfg,
                    const std::vector<len_type>& len_AB,
                    const std::vector<len_type>& len_AC,
                    const std::vector<len_type>& len_BC,
-                   T alpha, const T* A,
+                   T alpha, bool conj_A, const T* A,
                    const std::vector<stride_type>& stride_A_AB,
                    const std::vector<stride_type>& stride_A_AC,
-                            const T* B,
+                            bool conj_B, const T* B,
                    const std::vector<stride_type>& stride_B_AB,
                    const std::vector<stride_type>& stride_B_BC,
-                   T  beta,       T* C,
+                   T  beta, bool conj_C,       T* C,
                    const std::vector<stride_type>& stride_C_AC,
-                   const std::vector<stride_type>& stride_C_BC)
+                   const std::vector<stride_type>& stride_C_BC,
+                   const tblis_epilogue* epilogue,
+                   const mult_layout<T>* layout)
 {
-    auto reorder_AC = detail::sort_by_stride(stride_C_AC, stride_A_AC);
-    auto reorder_BC = detail::sort_by_stride(stride_C_BC, stride_B_BC);
-    auto reorder_AB = detail::sort_by_stride(stride_A_AB, stride_B_AB);
+    mult_layout<T> local_layout;
 
-    tensor_matrix<T> at(stl_ext::permuted(len_AC, reorder_AC),
-                        stl_ext::permuted(len_AB, reorder_AB),
-                        const_cast<T*>(A),
-                        stl_ext::permuted(stride_A_AC, reorder_AC),
-                        stl_ext::permuted(stride_A_AB, reorder_AB));
+    if (!layout)
+    {
+        init_mult_layout(comm, cfg, comm.num_threads(), local_layout,
+                         {}, {}, {}, len_AB, len_AC, len_BC, {},
+                         {}, stride_A_AB, stride_A_AC,
+                         {}, stride_B_AB, stride_B_BC,
+                         {}, stride_C_AC, stride_C_BC);
+        layout = &local_layout;
+    }
 
-    tensor_matrix<T> bt(stl_ext::permuted(len_AB, reorder_AB),
-                        stl_ext::permuted(len_BC, reorder_BC),
-                        const_cast<T*>(B),
-                        stl_ext::permuted(stride_B_AB, reorder_AB),
-                        stl_ext::permuted(stride_B_BC, reorder_BC));
+    /*
+     * Each thread needs its own copy of the matrices, since the partitioning
+     * nodes shift them around.
+     */
+    const bool transpose = layout->transpose;
+    tensor_matrix<T> at(layout->at);
+    tensor_matrix<T> bt(layout->bt);
+    tensor_matrix<T> ct(layout->ct);
+    at.data(const_cast<T*>(transpose ? B : A));
+    bt.data(const_cast<T*>(transpose ? A : B));
+    ct.data(C);
+
+    if (transpose) std::swap(conj_A, conj_B);
+
+    TensorGEMM gemm;
+    step<3>(gemm).conj = conj_B;
+    step<6>(gemm).conj = conj_A;
+    leaf(gemm).conj_C = conj_C;
+    leaf(gemm).epilogue = epilogue;
+
+    len_type k = at.length(1);
+
+    const auto& tc = layout->tc;
+    step<0>(gemm).distribute = tc.jc_nt;
+    step<4>(gemm).distribute = tc.ic_nt;
+    step<8>(gemm).distribute = tc.jr_nt;
+    step<9>(gemm).distribute = tc.ir_nt;
+
+    if (tc.pc_nt == 1)
+    {
+        gemm(comm, cfg, alpha, at, bt, beta, ct);
+
+        /*
+         * Don't free the scatter vectors until all threads are done with them.
+         */
+        comm.barrier();
+        return;
+    }
+
+    /*
+     * Split k between tc.pc_nt gangs. The first gang updates C directly, and
+     * the others each compute their part of the product into a private
+     * buffer, which are then added into C by all threads. The buffers are
+     * laid out in the same order as C, so that they are transposed (or not)
+     * in the same way. The epilogue can only be applied once all parts have
+     * been summed.
+     */
+    auto subcomm = comm.gang(TCI_EVENLY, tc.pc_nt);
+
+    const len_type KR = cfg.gemm_kr.def<T>();
+
+    len_type k_first, k_last;
+    std::tie(k_first, k_last, std::ignore) =
+        subcomm.distribute_over_gangs(k, KR);
+
+    auto len_C = len_AC + len_BC;
+    auto stride_C = stride_C_AC + stride_C_BC;
+    const auto& stride_P = layout->stride_P;
+    stride_type size_P = layout->size_P;
+
+    MemoryPool::Block buffer;
+    T* P = nullptr;
+
+    if (comm.master())
+    {
+        buffer = BuffersForC.allocate<T>((tc.pc_nt-1)*size_P);
+        P = buffer.get<T>();
+    }
+
+    comm.broadcast(P);
+
+    at.shift(1, k_first);
+    at.length(1, k_last-k_first);
+    bt.shift(0, k_first);
+    bt.length(0, k_last-k_first);
+
+    leaf(gemm).epilogue = nullptr;
+
+    /*
+     * If k is very short then some gangs may not get any of it.
+     */
+    if (subcomm.gang_num() == 0)
+    {
+        if (k_last > k_first)
+            gemm(subcomm, cfg, alpha, at, bt, beta, ct);
+        else if (beta == T(0))
+            set(subcomm, cfg, len_C, T(0), C, stride_C);
+        else
+            scale(subcomm, cfg, len_C, beta, conj_C, C, stride_C);
+    }
+    else
+    {
+        T* P_gang = P + (subcomm.gang_num()-1)*size_P;
+
+        if (k_last > k_first)
+        {
+            tensor_matrix<T> pt(layout->pt);
+            pt.data(P_gang);
+
+            leaf(gemm).conj_C = false;
+            gemm(subcomm, cfg, alpha, at, bt, T(0), pt);
+        }
+        else
+        {
+            set(subcomm, cfg, len_C, T(0), P_gang, stride_P);
+        }
+    }
+
+    comm.barrier();
+
+    for (int gang = 1;gang < tc.pc_nt;gang++)
+        add(comm, cfg, {}, {}, len_C,
+            T(1), false, P + (gang-1)*size_P, {}, stride_P,
+            T(1), false,                   C, {}, stride_C);
+
+    if (epilogue)
+        apply_epilogue(comm, len_C, C, stride_C, epilogue);
+}
+
+template <typename T>
+void contract_blis(const communicator& comm, const config& cfg,
+                   const std::vector<len_type>& len_AB,
+                   const std::vector<len_type>& len_AC,
+                   const std::vector<len_type>& len_BC,
+                   T alpha, bool conj_A, const T* A,
+                   const std::vector<stride_type>& stride_A_AB,
+                   const std::vector<stride_type>& stride_A_AC,
+                            bool conj_B, const T* B,
+                   const std::vector<stride_type>& stride_B_AB,
+                   const std::vector<stride_type>& stride_B_BC,
+                   T  beta, bool conj_C,       T* C,
+                   const std::vector<stride_type>& stride_C_AC,
+                   const std::vector<stride_type>& stride_C_BC,
+                   const tblis_epilogue* epilogue)
+{
+    contract_blis<T>(comm, cfg, len_AB, len_AC, len_BC,
+                     alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                            conj_B, B, stride_B_AB, stride_B_BC,
+                      beta, conj_C, C, stride_C_AC, stride_C_BC,
+                     epilogue, nullptr);
+}
+
+#define INSTANTIATE_CONTRACT_BLIS(T) \
+template void contract_blis(const communicator& comm, const config& cfg, \
+                            const std::vector<len_type>& len_AB, \
+                            const std::vector<len_type>& len_AC, \
+                            const std::vector<len_type>& len_BC, \
+                            T alpha, bool conj_A, const T* A, \
+                            const std::vector<stride_type>& stride_A_AB, \
+                            const std::vector<stride_type>& stride_A_AC, \
+                                     bool conj_B, const T* B, \
+                            const std::vector<stride_type>& stride_B_AB, \
+                            const std::vector<stride_type>& stride_B_BC, \
+                            T  beta, bool conj_C,       T* C, \
+                            const std::vector<stride_type>& stride_C_AC, \
+                            const std::vector<stride_type>& stride_C_BC, \
+                            const tblis_epilogue* epilogue);
+
+INSTANTIATE_CONTRACT_BLIS(float);
+INSTANTIATE_CONTRACT_BLIS(double);
+INSTANTIATE_CONTRACT_BLIS(scomplex);
+INSTANTIATE_CONTRACT_BLIS(dcomplex);
+
+template <typename T>
+void mult_sum_blis(const communicator& comm, const config& cfg,
+                   multi_tensor_matrix<T>& at, multi_tensor_matrix<T>& bt,
+                   T beta, bool conj_C, tensor_matrix<T>& ct)
+{
+    const len_type MR = cfg.gemm_mr.def<T>();
+    const len_type NR = cfg.gemm_nr.def<T>();
+    const len_type KR = cfg.gemm_kr.def<T>();
+
+    auto scat_A = block_scatter(comm, BuffersForScatter, at, MR, KR);
+    auto scat_B = block_scatter(comm, BuffersForScatter, bt, KR, NR);
+    auto scat_C = block_scatter(comm, BuffersForScatter, ct, MR, NR);
+
+    TensorGEMM gemm;
+    leaf(gemm).conj_C = conj_C;
+
+    len_type m = ct.length(0);
+    len_type n = ct.length(1);
+    len_type k = at.length(1);
+
+    int nt = comm.num_threads();
+    auto tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
+    step<0>(gemm).distribute = tc.jc_nt;
+    step<4>(gemm).distribute = tc.ic_nt;
+    step<8>(gemm).distribute = tc.jr_nt;
+    step<9>(gemm).distribute = tc.ir_nt;
+
+    /*
+     * The scaling factors and conjugation of the individual terms are
+     * applied during packing.
+     */
+    gemm(comm, cfg, T(1), at, bt, beta, ct);
+
+    /*
+     * Don't free the scatter vectors until all threads are done with them.
+     */
+    comm.barrier();
+}
+
+template <typename T>
+void mult_sum(const communicator& comm, const config& cfg,
+              const std::vector<std::vector<len_type>>& len_AB,
+              const std::vector<len_type>& len_AC,
+              const std::vector<len_type>& len_BC,
+              const std::vector<T>& alpha,
+              const std::vector<bool>& conj_A,
+              const std::vector<const T*>& A,
+              const std::vector<std::vector<stride_type>>& stride_A_AB,
+              const std::vector<std::vector<stride_type>>& stride_A_AC,
+              const std::vector<bool>& conj_B,
+              const std::vector<const T*>& B,
+              const std::vector<std::vector<stride_type>>& stride_B_AB,
+              const std::vector<std::vector<stride_type>>& stride_B_BC,
+              T  beta, bool conj_C, T* C,
+              const std::vector<stride_type>& stride_C_AC,
+              const std::vector<stride_type>& stride_C_BC)
+{
+    auto nterm = A.size();
+
+    TBLIS_ASSERT(len_AB.size() == nterm);
+    TBLIS_ASSERT(alpha.size() == nterm);
+    TBLIS_ASSERT(conj_A.size() == nterm);
+    TBLIS_ASSERT(stride_A_AB.size() == nterm);
+    TBLIS_ASSERT(stride_A_AC.size() == nterm);
+    TBLIS_ASSERT(conj_B.size() == nterm);
+    TBLIS_ASSERT(B.size() == nterm);
+    TBLIS_ASSERT(stride_B_AB.size() == nterm);
+    TBLIS_ASSERT(stride_B_BC.size() == nterm);
+
+    /*
+     * The row and column indices of C are ordered the same way for every
+     * term, while the contracted indices are ordered separately for each.
+     */
+    auto reorder_AC = detail::sort_by_stride(stride_C_AC);
+    auto reorder_BC = detail::sort_by_stride(stride_C_BC);
+
+    multi_tensor_matrix<T> at(1);
+    multi_tensor_matrix<T> bt(0);
+
+    for (size_t i = 0;i < nterm;i++)
+    {
+        auto reorder_AB = detail::sort_by_stride(stride_A_AB[i], stride_B_AB[i]);
+
+        at.push_back(tensor_matrix<T>(stl_ext::permuted(len_AC, reorder_AC),
+                                      stl_ext::permuted(len_AB[i], reorder_AB),
+                                      const_cast<T*>(A[i]),
+                                      stl_ext::permuted(stride_A_AC[i], reorder_AC),
+                                      stl_ext::permuted(stride_A_AB[i], reorder_AB)),
+                     alpha[i], conj_A[i]);
+
+        bt.push_back(tensor_matrix<T>(stl_ext::permuted(len_AB[i], reorder_AB),
+                                      stl_ext::permuted(len_BC, reorder_BC),
+                                      const_cast<T*>(B[i]),
+                                      stl_ext::permuted(stride_B_AB[i], reorder_AB),
+                                      stl_ext::permuted(stride_B_BC[i], reorder_BC)),
+                     T(1), conj_B[i]);
+    }
 
     tensor_matrix<T> ct(stl_ext::permuted(len_AC, reorder_AC),
                         stl_ext::permuted(len_BC, reorder_BC),
@@ -195,6 +479,155 @@ void contract_blis(const communicator& comm, const config& cfg,
     const bool row_major = cfg.gemm_row_major.value<T>();
 
     if (ct.stride(!row_major) == 1)
+    {
+        /*
+         * Compute C^T = B^T * A^T instead
+         */
+        at.transpose();
+        bt.transpose();
+        ct.transpose();
+        mult_sum_blis(comm, cfg, bt, at, beta, conj_C, ct);
+    }
+    else
+    {
+        mult_sum_blis(comm, cfg, at, bt, beta, conj_C, ct);
+    }
+}
+
+#define INSTANTIATE_MULT_SUM(T) \
+template void mult_sum(const communicator& comm, const config& cfg, \
+                       const std::vector<std::vector<len_type>>& len_AB, \
+                       const std::vector<len_type>& len_AC, \
+                       const std::vector<len_type>& len_BC, \
+                       const std::vector<T>& alpha, \
+                       const std::vector<bool>& conj_A, \
+                       const std::vector<const T*>& A, \
+                       const std::vector<std::vector<stride_type>>& stride_A_AB, \
+                       const std::vector<std::vector<stride_type>>& stride_A_AC, \
+                       const std::vector<bool>& conj_B, \
+                       const std::vector<const T*>& B, \
+                       const std::vector<std::vector<stride_type>>& stride_B_AB, \
+                       const std::vector<std::vector<stride_type>>& stride_B_BC, \
+                       T  beta, bool conj_C, T* C, \
+                       const std::vector<stride_type>& stride_C_AC, \
+                       const std::vector<stride_type>& stride_C_BC);
+
+INSTANTIATE_MULT_SUM(float);
+INSTANTIATE_MULT_SUM(double);
+INSTANTIATE_MULT_SUM(scomplex);
+INSTANTIATE_MULT_SUM(dcomplex);
+
+inline len_type extra_length(const std::vector<len_type>& len)
+{
+    return len.empty() ? 0 : stl_ext::prod(len);
+}
+
+inline void fill_extra_offsets(const std::vector<len_type>& len,
+                               const std::vector<stride_type>& stride,
+                               stride_type* offsets)
+{
+    if (len.empty()) return;
+
+    MArray::viterator<1> iter(len, stride);
+    stride_type off = 0;
+    while (iter.next(off)) *(offsets++) = off;
+}
+
+template <typename T>
+void init_mult_layout(const communicator& comm, const config& cfg,
+                      unsigned nthread, mult_layout<T>& layout,
+                      const std::vector<len_type>& len_A,
+                      const std::vector<len_type>& len_B,
+                      const std::vector<len_type>& len_C,
+                      const std::vector<len_type>& len_AB,
+                      const std::vector<len_type>& len_AC,
+                      const std::vector<len_type>& len_BC,
+                      const std::vector<len_type>& len_ABC,
+                      const std::vector<stride_type>& stride_A_A,
+                      const std::vector<stride_type>& stride_A_AB,
+                      const std::vector<stride_type>& stride_A_AC,
+                      const std::vector<stride_type>& stride_B_B,
+                      const std::vector<stride_type>& stride_B_AB,
+                      const std::vector<stride_type>& stride_B_BC,
+                      const std::vector<stride_type>& stride_C_C,
+                      const std::vector<stride_type>& stride_C_AC,
+                      const std::vector<stride_type>& stride_C_BC)
+{
+    /*
+     * Weightings and outer products go to weight_blis, and empty products
+     * never get as far as the GEMM (see mult and mult_blis).
+     */
+    if (len_A.empty() && len_B.empty() && len_C.empty() && len_AB.empty())
+        return;
+
+    if (stl_ext::prod(len_A)*stl_ext::prod(len_B)*
+        stl_ext::prod(len_C)*stl_ext::prod(len_ABC) == 0) return;
+
+    /*
+     * Only plain contractions (those handled by contract_blis) split k.
+     */
+    const bool split_k = len_A.empty() && len_B.empty() && len_C.empty() &&
+                         len_ABC.empty();
+
+    /*
+     * Indices which appear only in A or B are summed over while packing, and
+     * indices which appear only in C are broadcast over when updating C. The
+     * offsets of each are computed once and shared by all threads.
+     */
+    len_type nextra_A = extra_length(len_A);
+    len_type nextra_B = extra_length(len_B);
+    len_type nextra_C = extra_length(len_C);
+
+    stride_type* extra_ptr = nullptr;
+
+    if (nextra_A || nextra_B || nextra_C)
+    {
+        if (comm.master())
+        {
+            layout.extra.resize(nextra_A+nextra_B+nextra_C);
+            extra_ptr = layout.extra.data();
+            fill_extra_offsets(len_A, stride_A_A, extra_ptr);
+            fill_extra_offsets(len_B, stride_B_B, extra_ptr+nextra_A);
+            fill_extra_offsets(len_C, stride_C_C, extra_ptr+nextra_A+nextra_B);
+        }
+
+        comm.broadcast(extra_ptr);
+    }
+
+    auto reorder_AC = detail::sort_by_stride(stride_C_AC, stride_A_AC);
+    auto reorder_BC = detail::sort_by_stride(stride_C_BC, stride_B_BC);
+    auto reorder_AB = detail::sort_by_stride(stride_A_AB, stride_B_AB);
+
+    auto& at = layout.at;
+    auto& bt = layout.bt;
+    auto& ct = layout.ct;
+
+    at.reset(stl_ext::permuted(len_AC, reorder_AC),
+             stl_ext::permuted(len_AB, reorder_AB),
+             nullptr,
+             stl_ext::permuted(stride_A_AC, reorder_AC),
+             stl_ext::permuted(stride_A_AB, reorder_AB));
+
+    bt.reset(stl_ext::permuted(len_AB, reorder_AB),
+             stl_ext::permuted(len_BC, reorder_BC),
+             nullptr,
+             stl_ext::permuted(stride_B_AB, reorder_AB),
+             stl_ext::permuted(stride_B_BC, reorder_BC));
+
+    ct.reset(stl_ext::permuted(len_AC, reorder_AC),
+             stl_ext::permuted(len_BC, reorder_BC),
+             nullptr,
+             stl_ext::permuted(stride_C_AC, reorder_AC),
+             stl_ext::permuted(stride_C_BC, reorder_BC));
+
+    at.extra_offsets(nextra_A, extra_ptr);
+    bt.extra_offsets(nextra_B, extra_ptr+nextra_A);
+    ct.extra_offsets(nextra_C, extra_ptr+nextra_A+nextra_B);
+
+    const bool row_major = cfg.gemm_row_major.value<T>();
+    layout.transpose = ct.stride(!row_major) == 1;
+
+    if (layout.transpose)
     {
         /*
          * Compute C^T = B^T * A^T instead
@@ -205,41 +638,223 @@ void contract_blis(const communicator& comm, const config& cfg,
         ct.transpose();
     }
 
-    TensorGEMM gemm;
+    /*
+     * The scatter vectors only depend on the layout, and so they can be
+     * shared by all threads and all batch elements.
+     */
+    const len_type MR = cfg.gemm_mr.def<T>();
+    const len_type NR = cfg.gemm_nr.def<T>();
+    const len_type KR = cfg.gemm_kr.def<T>();
+
+    layout.scat_A = block_scatter(comm, BuffersForScatter, at, MR, KR);
+    layout.scat_B = block_scatter(comm, BuffersForScatter, bt, KR, NR);
+    layout.scat_C = block_scatter(comm, BuffersForScatter, ct, MR, NR);
 
     len_type m = ct.length(0);
     len_type n = ct.length(1);
     len_type k = at.length(1);
 
-    int nt = comm.num_threads();
-    auto tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
+    if (!split_k)
+    {
+        /*
+         * Give each gang whole batch elements first, and only split the
+         * individual GEMMs over the threads that are left over.
+         */
+        len_type nbatch = stl_ext::prod(len_ABC);
+        unsigned ngang = std::min<len_type>(nthread, nbatch);
+        for (;ngang > 1;ngang--)
+        {
+            if (nthread%ngang == 0) break;
+        }
+
+        layout.ngang = ngang;
+        layout.tc = make_gemm_thread_config<T>(cfg, nthread/ngang, m, n, k);
+        return;
+    }
+
+    layout.ngang = 1;
+    layout.tc = make_gemm_thread_config<T>(cfg, nthread, m, n, k, true);
+
+    if (layout.tc.pc_nt == 1) return;
+
+    /*
+     * The private copies of C for split-K are dense, with the indices in
+     * the same order (by stride) as in C.
+     */
+    auto stride_C = stride_C_AC + stride_C_BC;
+    auto len_C_ = len_AC + len_BC;
+    auto& stride_P = layout.stride_P;
+    stride_P.resize(stride_C.size());
+    layout.size_P = 1;
+    for (auto i : detail::sort_by_stride(stride_C))
+    {
+        stride_P[i] = layout.size_P;
+        layout.size_P *= len_C_[i];
+    }
+
+    std::vector<stride_type> stride_P_AC(stride_P.begin(), stride_P.begin()+len_AC.size());
+    std::vector<stride_type> stride_P_BC(stride_P.begin()+len_AC.size(), stride_P.end());
+
+    layout.pt.reset(stl_ext::permuted(len_AC, reorder_AC),
+                    stl_ext::permuted(len_BC, reorder_BC),
+                    nullptr,
+                    stl_ext::permuted(stride_P_AC, reorder_AC),
+                    stl_ext::permuted(stride_P_BC, reorder_BC));
+    if (layout.transpose) layout.pt.transpose();
+}
+
+#define INSTANTIATE_INIT_MULT_LAYOUT(T) \
+template void init_mult_layout(const communicator& comm, const config& cfg, \
+                               unsigned nthread, mult_layout<T>& layout, \
+                               const std::vector<len_type>& len_A, \
+                               const std::vector<len_type>& len_B, \
+                               const std::vector<len_type>& len_C, \
+                               const std::vector<len_type>& len_AB, \
+                               const std::vector<len_type>& len_AC, \
+                               const std::vector<len_type>& len_BC, \
+                               const std::vector<len_type>& len_ABC, \
+                               const std::vector<stride_type>& stride_A_A, \
+                               const std::vector<stride_type>& stride_A_AB, \
+                               const std::vector<stride_type>& stride_A_AC, \
+                               const std::vector<stride_type>& stride_B_B, \
+                               const std::vector<stride_type>& stride_B_AB, \
+                               const std::vector<stride_type>& stride_B_BC, \
+                               const std::vector<stride_type>& stride_C_C, \
+                               const std::vector<stride_type>& stride_C_AC, \
+                               const std::vector<stride_type>& stride_C_BC);
+
+INSTANTIATE_INIT_MULT_LAYOUT(float);
+INSTANTIATE_INIT_MULT_LAYOUT(double);
+INSTANTIATE_INIT_MULT_LAYOUT(scomplex);
+INSTANTIATE_INIT_MULT_LAYOUT(dcomplex);
+
+template <typename T>
+void mult_blis(const communicator& comm, const config& cfg,
+               const std::vector<len_type>& len_A,
+               const std::vector<len_type>& len_B,
+               const std::vector<len_type>& len_C,
+               const std::vector<len_type>& len_AB,
+               const std::vector<len_type>& len_AC,
+               const std::vector<len_type>& len_BC,
+               const std::vector<len_type>& len_ABC,
+               T alpha, bool conj_A, const T* A,
+               const std::vector<stride_type>& stride_A_A,
+               const std::vector<stride_type>& stride_A_AB,
+               const std::vector<stride_type>& stride_A_AC,
+               const std::vector<stride_type>& stride_A_ABC,
+                        bool conj_B, const T* B,
+               const std::vector<stride_type>& stride_B_B,
+               const std::vector<stride_type>& stride_B_AB,
+               const std::vector<stride_type>& stride_B_BC,
+               const std::vector<stride_type>& stride_B_ABC,
+               T  beta, bool conj_C,       T* C,
+               const std::vector<stride_type>& stride_C_C,
+               const std::vector<stride_type>& stride_C_AC,
+               const std::vector<stride_type>& stride_C_BC,
+               const std::vector<stride_type>& stride_C_ABC,
+               const tblis_epilogue* epilogue,
+               const mult_layout<T>* layout)
+{
+    len_type nextra_A = extra_length(len_A);
+    len_type nextra_B = extra_length(len_B);
+    len_type nextra_C = extra_length(len_C);
+
+    /*
+     * A zero-length index which appears only in C means that C is empty,
+     * while one which appears only in A or B means that the sum is empty and
+     * so C = beta*C.
+     */
+    if (!len_C.empty() && nextra_C == 0) return;
+
+    /*
+     * Likewise for a zero-length batch index, which would otherwise leave
+     * no gangs to split the threads into.
+     */
+    if (stl_ext::prod(len_ABC) == 0) return;
+
+    if ((!len_A.empty() && nextra_A == 0) ||
+        (!len_B.empty() && nextra_B == 0))
+    {
+        auto len = len_C+len_AC+len_BC+len_ABC;
+        auto stride = stride_C_C+stride_C_AC+stride_C_BC+stride_C_ABC;
+
+        if (beta == T(0))
+            set(comm, cfg, len, T(0), C, stride);
+        else
+            scale(comm, cfg, len, beta, conj_C, C, stride);
+
+        if (epilogue)
+            apply_epilogue(comm, len, C, stride, epilogue);
+
+        return;
+    }
+
+    mult_layout<T> local_layout;
+
+    if (!layout)
+    {
+        init_mult_layout(comm, cfg, comm.num_threads(), local_layout,
+                         len_A, len_B, len_C, len_AB, len_AC, len_BC, len_ABC,
+                         stride_A_A, stride_A_AB, stride_A_AC,
+                         stride_B_B, stride_B_AB, stride_B_BC,
+                         stride_C_C, stride_C_AC, stride_C_BC);
+        layout = &local_layout;
+    }
+
+    /*
+     * Each thread needs its own copy of the matrices, since the partitioning
+     * nodes shift them around.
+     */
+    const bool transpose = layout->transpose;
+    tensor_matrix<T> at(layout->at);
+    tensor_matrix<T> bt(layout->bt);
+    tensor_matrix<T> ct(layout->ct);
+
+    if (transpose) std::swap(conj_A, conj_B);
+
+    len_type nbatch = stl_ext::prod(len_ABC);
+    auto subcomm = comm.gang(TCI_EVENLY, layout->ngang);
+
+    /*
+     * The same control tree (and hence the same packing and scatter buffers)
+     * is reused for every batch element handled by this gang.
+     */
+    TensorGEMM gemm;
+    step<3>(gemm).conj = conj_B;
+    step<6>(gemm).conj = conj_A;
+    leaf(gemm).conj_C = conj_C;
+    leaf(gemm).epilogue = epilogue;
+
+    const auto& tc = layout->tc;
     step<0>(gemm).distribute = tc.jc_nt;
     step<4>(gemm).distribute = tc.ic_nt;
     step<8>(gemm).distribute = tc.jr_nt;
     step<9>(gemm).distribute = tc.ir_nt;
 
-    gemm(comm, cfg, alpha, at, bt, beta, ct);
-}
+    len_type batch_first, batch_last;
+    std::tie(batch_first, batch_last, std::ignore) =
+        subcomm.distribute_over_gangs(nbatch);
 
-#define INSTANTIATE_CONTRACT_BLIS(T) \
-template void contract_blis(const communicator& comm, const config& cfg, \
-                            const std::vector<len_type>& len_AB, \
-                            const std::vector<len_type>& len_AC, \
-                            const std::vector<len_type>& len_BC, \
-                            T alpha, const T* A, \
-                            const std::vector<stride_type>& stride_A_AB, \
-                            const std::vector<stride_type>& stride_A_AC, \
-                                     const T* B, \
-                            const std::vector<stride_type>& stride_B_AB, \
-                            const std::vector<stride_type>& stride_B_BC, \
-                            T  beta,       T* C, \
-                            const std::vector<stride_type>& stride_C_AC, \
-                            const std::vector<stride_type>& stride_C_BC);
+    MArray::viterator<3> iter_ABC(len_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
+    iter_ABC.position(batch_first, A, B, C);
 
-INSTANTIATE_CONTRACT_BLIS(float);
-INSTANTIATE_CONTRACT_BLIS(double);
-INSTANTIATE_CONTRACT_BLIS(scomplex);
-INSTANTIATE_CONTRACT_BLIS(dcomplex);
+    for (len_type batch = batch_first;batch < batch_last;batch++)
+    {
+        iter_ABC.next(A, B, C);
+
+        at.data(const_cast<T*>(transpose ? B : A));
+        bt.data(const_cast<T*>(transpose ? A : B));
+        ct.data(C);
+
+        gemm(subcomm, cfg, alpha, at, bt, beta, ct);
+    }
+
+    /*
+     * Don't free the extra offsets and scatter vectors until all threads
+     * are done with them.
+     */
+    comm.barrier();
+}
 
 template <typename T>
 void mult_blas(const communicator& comm, const config& cfg,
@@ -250,17 +865,17 @@ void mult_blas(const communicator& comm, const config& cfg,
                const std::vector<len_type>& len_AC,
                const std::vector<len_type>& len_BC,
                const std::vector<len_type>& len_ABC,
-               T alpha, const T* A,
+               T alpha, bool conj_A, const T* A,
                const std::vector<stride_type>& stride_A_A,
                const std::vector<stride_type>& stride_A_AB,
                const std::vector<stride_type>& stride_A_AC,
                const std::vector<stride_type>& stride_A_ABC,
-                        const T* B,
+                        bool conj_B, const T* B,
                const std::vector<stride_type>& stride_B_B,
                const std::vector<stride_type>& stride_B_AB,
                const std::vector<stride_type>& stride_B_BC,
                const std::vector<stride_type>& stride_B_ABC,
-               T  beta,       T* C,
+               T  beta, bool conj_C,       T* C,
                const std::vector<stride_type>& stride_C_C,
                const std::vector<stride_type>& stride_C_AC,
                const std::vector<stride_type>& stride_C_BC,
@@ -296,12 +911,12 @@ void mult_blas(const communicator& comm, const config& cfg,
     while (it.next(A, B, C))
     {
         add(comm, cfg, len_A, {}, arv.lengths(),
-            T(1), false,          A, stride_A_A, stride_A_AC+stride_A_AB,
-            T(0), false, arv.data(),         {},           arv.strides());
+            T(1), conj_A,          A, stride_A_A, stride_A_AC+stride_A_AB,
+            T(0),  false, arv.data(),         {},           arv.strides());
 
         add(comm, cfg, len_B, {}, brv.lengths(),
-            T(1), false,          B, stride_B_B, stride_B_AB+stride_B_BC,
-            T(0), false, brv.data(),         {},           brv.strides());
+            T(1), conj_B,          B, stride_B_B, stride_B_AB+stride_B_BC,
+            T(0),  false, brv.data(),         {},           brv.strides());
 
         mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
              alpha, false, am.data(), am.stride(0), am.stride(1),
@@ -309,8 +924,8 @@ void mult_blas(const communicator& comm, const config& cfg,
               T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
         add(comm, cfg, {}, len_C, crv.lengths(),
-            T(1), false, crv.data(),         {},            crv.strides(),
-            beta, false,          C, stride_C_C, stride_C_AC+stride_C_BC);
+            T(1),  false, crv.data(),         {},            crv.strides(),
+            beta, conj_C,          C, stride_C_C, stride_C_AC+stride_C_BC);
     }
 }
 
@@ -323,17 +938,17 @@ void mult_ref(const communicator& comm, const config& cfg,
               const std::vector<len_type>& len_AC,
               const std::vector<len_type>& len_BC,
               const std::vector<len_type>& len_ABC,
-              T alpha, const T* A,
+              T alpha, bool conj_A, const T* A,
               const std::vector<stride_type>& stride_A_A,
               const std::vector<stride_type>& stride_A_AB,
               const std::vector<stride_type>& stride_A_AC,
               const std::vector<stride_type>& stride_A_ABC,
-                       const T* B,
+                       bool conj_B, const T* B,
               const std::vector<stride_type>& stride_B_B,
               const std::vector<stride_type>& stride_B_AB,
               const std::vector<stride_type>& stride_B_BC,
               const std::vector<stride_type>& stride_B_ABC,
-              T  beta,       T* C,
+              T  beta, bool conj_C,       T* C,
               const std::vector<stride_type>& stride_C_C,
               const std::vector<stride_type>& stride_C_AC,
               const std::vector<stride_type>& stride_C_BC,
@@ -379,7 +994,7 @@ void mult_ref(const communicator& comm, const config& cfg,
                         temp_B += *B;
                     }
 
-                    temp += temp_A*temp_B;
+                    temp += conj(conj_A, temp_A)*conj(conj_B, temp_B);
                 }
 
                 temp *= alpha;
@@ -395,7 +1010,7 @@ void mult_ref(const communicator& comm, const config& cfg,
                 {
                     while (iter_C.next(C))
                     {
-                        *C = temp + beta*(*C);
+                        *C = temp + beta*conj(conj_C, *C);
                     }
                 }
             }
@@ -407,11 +1022,11 @@ template <typename T>
 void outer_prod_blas(const communicator& comm, const config& cfg,
                      const std::vector<len_type>& len_AC,
                      const std::vector<len_type>& len_BC,
-                     T alpha, const T* A,
+                     T alpha, bool conj_A, const T* A,
                      const std::vector<stride_type>& stride_A_AC,
-                              const T* B,
+                              bool conj_B, const T* B,
                      const std::vector<stride_type>& stride_B_BC,
-                     T  beta,       T* C,
+                     T  beta, bool conj_C,       T* C,
                      const std::vector<stride_type>& stride_C_AC,
                      const std::vector<stride_type>& stride_C_BC)
 {
@@ -441,12 +1056,12 @@ void outer_prod_blas(const communicator& comm, const config& cfg,
     matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
 
     add(comm, cfg, {}, {}, arv.lengths(),
-        T(1), false,          A, {},   stride_A_AC,
-        T(0), false, arv.data(), {}, arv.strides());
+        T(1), conj_A,          A, {},   stride_A_AC,
+        T(0),  false, arv.data(), {}, arv.strides());
 
     add(comm, cfg, {}, {}, brv.lengths(),
-        T(1), false,          B, {},   stride_B_BC,
-        T(0), false, brv.data(), {}, brv.strides());
+        T(1), conj_B,          B, {},   stride_B_BC,
+        T(0),  false, brv.data(), {}, brv.strides());
 
     mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
          alpha, false, am.data(), am.stride(0), am.stride(1),
@@ -454,19 +1069,19 @@ void outer_prod_blas(const communicator& comm, const config& cfg,
           T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
     add(comm, cfg, {}, {}, crv.lengths(),
-        T(1), false, crv.data(), {},            crv.strides(),
-        beta, false,          C, {}, stride_C_AC+stride_C_BC);
+        T(1),  false, crv.data(), {},            crv.strides(),
+        beta, conj_C,          C, {}, stride_C_AC+stride_C_BC);
 }
 
 template <typename T>
 void outer_prod_ref(const communicator& comm, const config& cfg,
                     const std::vector<len_type>& len_AC,
                     const std::vector<len_type>& len_BC,
-                    T alpha, const T* A,
+                    T alpha, bool conj_A, const T* A,
                     const std::vector<stride_type>& stride_A_AC,
-                             const T* B,
+                             bool conj_B, const T* B,
                     const std::vector<stride_type>& stride_B_BC,
-                    T  beta,       T* C,
+                    T  beta, bool conj_C,       T* C,
                     const std::vector<stride_type>& stride_C_AC,
                     const std::vector<stride_type>& stride_C_BC)
 {
@@ -502,7 +1117,7 @@ void outer_prod_ref(const communicator& comm, const config& cfg,
             for (len_type j = n_min;j < n_max;j++)
             {
                 iter_BC.next(B, C);
-                *C = alpha*(*A)*(*B);
+                *C = alpha*conj(conj_A, *A)*conj(conj_B, *B);
             }
         }
         else
@@ -510,7 +1125,8 @@ void outer_prod_ref(const communicator& comm, const config& cfg,
             for (len_type j = n_min;j < n_max;j++)
             {
                 iter_BC.next(B, C);
-                *C = alpha*(*A)*(*B) + beta*(*C);
+                *C = alpha*conj(conj_A, *A)*conj(conj_B, *B) +
+                     beta*conj(conj_C, *C);
             }
         }
     }
@@ -521,13 +1137,13 @@ void weight_blas(const communicator& comm, const config& cfg,
                  const std::vector<len_type>& len_AC,
                  const std::vector<len_type>& len_BC,
                  const std::vector<len_type>& len_ABC,
-                 T alpha, const T* A,
+                 T alpha, bool conj_A, const T* A,
                  const std::vector<stride_type>& stride_A_AC,
                  const std::vector<stride_type>& stride_A_ABC,
-                          const T* B,
+                          bool conj_B, const T* B,
                  const std::vector<stride_type>& stride_B_BC,
                  const std::vector<stride_type>& stride_B_ABC,
-                 T  beta,       T* C,
+                 T  beta, bool conj_C,       T* C,
                  const std::vector<stride_type>& stride_C_AC,
                  const std::vector<stride_type>& stride_C_BC,
                  const std::vector<stride_type>& stride_C_ABC)
@@ -562,12 +1178,12 @@ void weight_blas(const communicator& comm, const config& cfg,
     while (it.next(A, B, C))
     {
         add(comm, cfg, {}, {}, arv.lengths(),
-            T(1), false,          A, {},   stride_A_AC,
-            T(0), false, arv.data(), {}, arv.strides());
+            T(1), conj_A,          A, {},   stride_A_AC,
+            T(0),  false, arv.data(), {}, arv.strides());
 
         add(comm, cfg, {}, {}, brv.lengths(),
-            T(1), false,          B, {},   stride_B_BC,
-            T(0), false, brv.data(), {}, brv.strides());
+            T(1), conj_B,          B, {},   stride_B_BC,
+            T(0),  false, brv.data(), {}, brv.strides());
 
         mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
              alpha, false, am.data(), am.stride(0), am.stride(1),
@@ -575,8 +1191,8 @@ void weight_blas(const communicator& comm, const config& cfg,
               T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
         add(comm, cfg, {}, {}, crv.lengths(),
-            T(1), false, crv.data(), {},            crv.strides(),
-            beta, false,          C, {}, stride_C_AC+stride_C_BC);
+            T(1),  false, crv.data(), {},            crv.strides(),
+            beta, conj_C,          C, {}, stride_C_AC+stride_C_BC);
     }
 }
 
@@ -585,13 +1201,13 @@ void weight_ref(const communicator& comm, const config& cfg,
                 const std::vector<len_type>& len_AC,
                 const std::vector<len_type>& len_BC,
                 const std::vector<len_type>& len_ABC,
-                T alpha, const T* A,
+                T alpha, bool conj_A, const T* A,
                 const std::vector<stride_type>& stride_A_AC,
                 const std::vector<stride_type>& stride_A_ABC,
-                         const T* B,
+                         bool conj_B, const T* B,
                 const std::vector<stride_type>& stride_B_BC,
                 const std::vector<stride_type>& stride_B_ABC,
-                T  beta,       T* C,
+                T  beta, bool conj_C,       T* C,
                 const std::vector<stride_type>& stride_C_AC,
                 const std::vector<stride_type>& stride_C_BC,
                 const std::vector<stride_type>& stride_C_ABC)
@@ -618,14 +1234,15 @@ void weight_ref(const communicator& comm, const config& cfg,
             {
                 while (iter_BC.next(B, C))
                 {
-                    *C = alpha*(*A)*(*B);
+                    *C = alpha*conj(conj_A, *A)*conj(conj_B, *B);
                 }
             }
             else
             {
                 while (iter_BC.next(B, C))
                 {
-                    *C = alpha*(*A)*(*B) + beta*(*C);
+                    *C = alpha*conj(conj_A, *A)*conj(conj_B, *B) +
+                         beta*conj(conj_C, *C);
                 }
             }
         }
@@ -633,7 +1250,424 @@ void weight_ref(const communicator& comm, const config& cfg,
 }
 
 template <typename T>
-void mult(const communicator& comm, const config& cfg,
+void weight_blis(const communicator& comm, const config& cfg,
+                 const std::vector<len_type>& len_AC,
+                 const std::vector<len_type>& len_BC,
+                 const std::vector<len_type>& len_ABC,
+                 T alpha, bool conj_A, const T* A,
+                 const std::vector<stride_type>& stride_A_AC,
+                 const std::vector<stride_type>& stride_A_ABC,
+                          bool conj_B, const T* B,
+                 const std::vector<stride_type>& stride_B_BC,
+                 const std::vector<stride_type>& stride_B_ABC,
+                 T  beta, bool conj_C,       T* C,
+                 const std::vector<stride_type>& stride_C_AC,
+                 const std::vector<stride_type>& stride_C_BC,
+                 const std::vector<stride_type>& stride_C_ABC)
+{
+    (void)cfg;
+
+    /*
+     * Each element of C is written exactly once: the inner loop runs along
+     * the dimension of C with the smallest stride, and all other dimensions
+     * (including the batch dimensions) are flattened into the rows of a
+     * 2-d iteration space which is partitioned over threads. Since the
+     * weighting is symmetric in A and B, swap them if necessary so that the
+     * inner loop comes from B.
+     */
+    auto len_AC_ = len_AC;
+    auto len_BC_ = len_BC;
+    auto stride_A_AC_ = stride_A_AC;
+    auto stride_B_BC_ = stride_B_BC;
+    auto stride_C_AC_ = stride_C_AC;
+    auto stride_C_BC_ = stride_C_BC;
+    auto stride_A_ABC_ = stride_A_ABC;
+    auto stride_B_ABC_ = stride_B_ABC;
+
+    auto min_stride = [](const std::vector<stride_type>& stride)
+    {
+        stride_type s = std::numeric_limits<stride_type>::max();
+        for (stride_type x : stride) s = std::min(s, std::abs(x));
+        return s;
+    };
+
+    if (min_stride(stride_C_AC) < min_stride(stride_C_BC))
+    {
+        using std::swap;
+        swap(A, B);
+        swap(conj_A, conj_B);
+        swap(len_AC_, len_BC_);
+        swap(stride_A_AC_, stride_B_BC_);
+        swap(stride_C_AC_, stride_C_BC_);
+        swap(stride_A_ABC_, stride_B_ABC_);
+    }
+
+    auto reorder_BC = detail::sort_by_stride(stride_C_BC_, stride_B_BC_);
+    len_BC_ = stl_ext::permuted(len_BC_, reorder_BC);
+    stride_B_BC_ = stl_ext::permuted(stride_B_BC_, reorder_BC);
+    stride_C_BC_ = stl_ext::permuted(stride_C_BC_, reorder_BC);
+
+    len_type n0 = (len_BC_.empty() ? 1 : len_BC_[0]);
+    stride_type stride_B0 = (len_BC_.empty() ? 0 : stride_B_BC_[0]);
+    stride_type stride_C0 = (len_BC_.empty() ? 0 : stride_C_BC_[0]);
+
+    if (!len_BC_.empty())
+    {
+        len_BC_.erase(len_BC_.begin());
+        stride_B_BC_.erase(stride_B_BC_.begin());
+        stride_C_BC_.erase(stride_C_BC_.begin());
+    }
+
+    MArray::viterator<3> iter_m(len_AC_ + len_ABC,
+                                stride_A_AC_ + stride_A_ABC_,
+                                std::vector<stride_type>(len_AC_.size()) + stride_B_ABC_,
+                                stride_C_AC_ + stride_C_ABC);
+    MArray::viterator<2> iter_n(len_BC_, stride_B_BC_, stride_C_BC_);
+    len_type m = stl_ext::prod(len_AC_)*stl_ext::prod(len_ABC);
+    len_type n = stl_ext::prod(len_BC_);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) = comm.distribute_over_threads_2d(m, n);
+
+    iter_m.position(m_min, A, B, C);
+
+    for (len_type i = m_min;i < m_max;i++)
+    {
+        iter_m.next(A, B, C);
+
+        T alpha_A = alpha*conj(conj_A, *A);
+        const T* B1 = B;
+              T* C1 = C;
+
+        iter_n.position(n_min, B1, C1);
+
+        for (len_type j = n_min;j < n_max;j++)
+        {
+            iter_n.next(B1, C1);
+
+            if (beta == T(0))
+            {
+                TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_B,
+                TBLIS_SPECIAL_CASE(stride_B0 == 1,
+                TBLIS_SPECIAL_CASE(stride_C0 == 1,
+                for (len_type i0 = 0;i0 < n0;i0++)
+                {
+                    C1[i0*stride_C0] = alpha_A*conj(conj_B, B1[i0*stride_B0]);
+                }
+                )));
+            }
+            else
+            {
+                TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_B,
+                TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_C,
+                TBLIS_SPECIAL_CASE(stride_B0 == 1,
+                TBLIS_SPECIAL_CASE(stride_C0 == 1,
+                for (len_type i0 = 0;i0 < n0;i0++)
+                {
+                    C1[i0*stride_C0] = alpha_A*conj(conj_B, B1[i0*stride_B0]) +
+                                       beta*conj(conj_C, C1[i0*stride_C0]);
+                }
+                ))));
+            }
+        }
+    }
+}
+
+/*
+ * Remove the index with the smallest stride in stride0 from len, stride0 and
+ * stride1, returning its length and strides (or a length of one if there
+ * are no indices).
+ */
+inline len_type peel_leading(std::vector<len_type>& len,
+                             std::vector<stride_type>& stride0,
+                             std::vector<stride_type>& stride1,
+                             stride_type& s0, stride_type& s1)
+{
+    if (len.empty())
+    {
+        s0 = s1 = 0;
+        return 1;
+    }
+
+    auto reorder = detail::sort_by_stride(stride0, stride1);
+    len = stl_ext::permuted(len, reorder);
+    stride0 = stl_ext::permuted(stride0, reorder);
+    stride1 = stl_ext::permuted(stride1, reorder);
+
+    len_type n0 = len[0];
+    s0 = stride0[0];
+    s1 = stride1[0];
+
+    len.erase(len.begin());
+    stride0.erase(stride0.begin());
+    stride1.erase(stride1.begin());
+
+    return n0;
+}
+
+/*
+ * Register-blocked update of an m x n (m <= MR, n <= NR) block of C. Rows and
+ * columns past the edge of the block re-read the last valid row/column so
+ * that the inner loops always have a fixed trip count.
+ */
+template <typename T, len_type MR, len_type NR>
+void mult_small_block(len_type m, len_type n, len_type k0,
+                      MArray::viterator<2>& iter_AB,
+                      T alpha, bool conj_A, const T* A, stride_type rs_A, stride_type cs_A,
+                               bool conj_B, const T* B, stride_type rs_B, stride_type cs_B,
+                      T  beta, bool conj_C,       T* C, stride_type rs_C, stride_type cs_C)
+{
+    stride_type off_A[MR], off_B[NR];
+    for (len_type i = 0;i < MR;i++) off_A[i] = std::min(i, m-1)*rs_A;
+    for (len_type j = 0;j < NR;j++) off_B[j] = std::min(j, n-1)*cs_B;
+
+    T AB[MR][NR] = {};
+
+    TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_A,
+    TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_B,
+    while (iter_AB.next(A, B))
+    {
+        for (len_type p = 0;p < k0;p++)
+        {
+            T a[MR], b[NR];
+            for (len_type i = 0;i < MR;i++) a[i] = conj(conj_A, A[off_A[i] + p*cs_A]);
+            for (len_type j = 0;j < NR;j++) b[j] = conj(conj_B, B[off_B[j] + p*rs_B]);
+
+            for (len_type i = 0;i < MR;i++)
+                for (len_type j = 0;j < NR;j++)
+                    AB[i][j] += a[i]*b[j];
+        }
+    }
+    ));
+
+    if (beta == T(0))
+    {
+        for (len_type i = 0;i < m;i++)
+            for (len_type j = 0;j < n;j++)
+                C[i*rs_C + j*cs_C] = alpha*AB[i][j];
+    }
+    else
+    {
+        for (len_type i = 0;i < m;i++)
+            for (len_type j = 0;j < n;j++)
+                C[i*rs_C + j*cs_C] = alpha*AB[i][j] +
+                                     beta*conj(conj_C, C[i*rs_C + j*cs_C]);
+    }
+}
+
+/*
+ * Single-threaded contraction for small tensors, with no packing, no
+ * temporary buffers, and no control tree. The AC and BC indices with the
+ * smallest strides in C are register-blocked, and the AB index with the
+ * smallest stride in A forms the innermost loop.
+ */
+template <typename T>
+void mult_small(const std::vector<len_type>& len_AB,
+                const std::vector<len_type>& len_AC,
+                const std::vector<len_type>& len_BC,
+                const std::vector<len_type>& len_ABC,
+                T alpha, bool conj_A, const T* A,
+                const std::vector<stride_type>& stride_A_AB,
+                const std::vector<stride_type>& stride_A_AC,
+                const std::vector<stride_type>& stride_A_ABC,
+                         bool conj_B, const T* B,
+                const std::vector<stride_type>& stride_B_AB,
+                const std::vector<stride_type>& stride_B_BC,
+                const std::vector<stride_type>& stride_B_ABC,
+                T  beta, bool conj_C,       T* C,
+                const std::vector<stride_type>& stride_C_AC,
+                const std::vector<stride_type>& stride_C_BC,
+                const std::vector<stride_type>& stride_C_ABC)
+{
+    constexpr len_type MR = 4;
+    constexpr len_type NR = 4;
+
+    auto len_AB_ = len_AB;
+    auto len_AC_ = len_AC;
+    auto len_BC_ = len_BC;
+    auto stride_A_AB_ = stride_A_AB;
+    auto stride_B_AB_ = stride_B_AB;
+    auto stride_A_AC_ = stride_A_AC;
+    auto stride_C_AC_ = stride_C_AC;
+    auto stride_B_BC_ = stride_B_BC;
+    auto stride_C_BC_ = stride_C_BC;
+
+    stride_type rs_A, cs_A, rs_B, cs_B, rs_C, cs_C;
+    len_type m0 = peel_leading(len_AC_, stride_C_AC_, stride_A_AC_, rs_C, rs_A);
+    len_type n0 = peel_leading(len_BC_, stride_C_BC_, stride_B_BC_, cs_C, cs_B);
+    len_type k0 = peel_leading(len_AB_, stride_A_AB_, stride_B_AB_, cs_A, rs_B);
+
+    MArray::viterator<3> iter_ABC(len_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
+    MArray::viterator<2> iter_AC(len_AC_, stride_A_AC_, stride_C_AC_);
+    MArray::viterator<2> iter_BC(len_BC_, stride_B_BC_, stride_C_BC_);
+    MArray::viterator<2> iter_AB(len_AB_, stride_A_AB_, stride_B_AB_);
+
+    while (iter_ABC.next(A, B, C))
+    {
+        while (iter_AC.next(A, C))
+        {
+            while (iter_BC.next(B, C))
+            {
+                for (len_type i = 0;i < m0;i += MR)
+                {
+                    for (len_type j = 0;j < n0;j += NR)
+                    {
+                        mult_small_block<T, MR, NR>(std::min(MR, m0-i),
+                                                    std::min(NR, n0-j), k0, iter_AB,
+                                                    alpha, conj_A, A + i*rs_A, rs_A, cs_A,
+                                                           conj_B, B + j*cs_B, rs_B, cs_B,
+                                                     beta, conj_C, C + i*rs_C + j*cs_C,
+                                                    rs_C, cs_C);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * A rough cost model, in units of one scalar multiply-add or one
+ * (cache-friendly) memory access, used to pick an implementation when
+ * impl == AUTOMATIC:
+ *
+ * - Contractions of less than small_tensor_flops without any indices
+ *   appearing in only one tensor go to mult_small, since at that point the
+ *   cost of starting threads and setting up the BLIS-based control tree
+ *   dominates.
+ *
+ * - The reference loops have no setup cost but are neither vectorized nor
+ *   blocked, and only some of them are parallelized.
+ *
+ * - The BLIS-based path packs directly from the tensors, which costs more
+ *   per element than packing a matrix, and has to go through a temporary
+ *   micro-tile for C unless the blocks of C have uniform strides.
+ *
+ * - The BLAS-based (TTGT) path permutes A, B, and C into temporaries, which
+ *   is cheap when each tensor has a unit-stride index, and otherwise runs
+ *   the matrix GEMM at full speed.
+ */
+template <typename T>
+impl_t select_impl(const config& cfg, unsigned nthread,
+                   const std::vector<len_type>& len_A,
+                   const std::vector<len_type>& len_B,
+                   const std::vector<len_type>& len_C,
+                   const std::vector<len_type>& len_AB,
+                   const std::vector<len_type>& len_AC,
+                   const std::vector<len_type>& len_BC,
+                   const std::vector<len_type>& len_ABC,
+                   const std::vector<stride_type>& stride_A_A,
+                   const std::vector<stride_type>& stride_A_AB,
+                   const std::vector<stride_type>& stride_A_AC,
+                   const std::vector<stride_type>& stride_A_ABC,
+                   const std::vector<stride_type>& stride_B_B,
+                   const std::vector<stride_type>& stride_B_AB,
+                   const std::vector<stride_type>& stride_B_BC,
+                   const std::vector<stride_type>& stride_B_ABC,
+                   const std::vector<stride_type>& stride_C_C,
+                   const std::vector<stride_type>& stride_C_AC,
+                   const std::vector<stride_type>& stride_C_BC,
+                   const std::vector<stride_type>& stride_C_ABC)
+{
+    const double MR = cfg.gemm_mr.def<T>();
+    const double NR = cfg.gemm_nr.def<T>();
+    const double KC = cfg.gemm_kc.def<T>();
+    const double NC = cfg.gemm_nc.def<T>();
+
+    const double m = stl_ext::prod(len_AC);
+    const double n = stl_ext::prod(len_BC);
+    const double k = stl_ext::prod(len_AB);
+    const double l = stl_ext::prod(len_ABC);
+    const double sum_A = stl_ext::prod(len_A);
+    const double sum_B = stl_ext::prod(len_B);
+    const double rep_C = stl_ext::prod(len_C);
+    const double nt = nthread;
+
+    auto has_unit_stride = [](std::initializer_list<const std::vector<stride_type>*> strides)
+    {
+        for (auto stride : strides)
+            for (auto s : *stride)
+                if (s == 1) return true;
+        return false;
+    };
+
+    auto leading_len = [](const std::vector<len_type>& len,
+                          const std::vector<stride_type>& stride) -> len_type
+    {
+        if (len.empty()) return 1;
+        auto it = std::min_element(stride.begin(), stride.end(),
+            [](stride_type a, stride_type b) { return std::abs(a) < std::abs(b); });
+        return len[it-stride.begin()];
+    };
+
+    const double perm_A = has_unit_stride({&stride_A_A, &stride_A_AB,
+                                           &stride_A_AC, &stride_A_ABC})
+                          ? 1 : no_unit_stride_factor;
+    const double perm_B = has_unit_stride({&stride_B_B, &stride_B_AB,
+                                           &stride_B_BC, &stride_B_ABC})
+                          ? 1 : no_unit_stride_factor;
+    const double perm_C = has_unit_stride({&stride_C_C, &stride_C_AC,
+                                           &stride_C_BC, &stride_C_ABC})
+                          ? 1 : no_unit_stride_factor;
+
+    const bool uniform_C = leading_len(len_AC, stride_C_AC)%len_type(MR) == 0 &&
+                           leading_len(len_BC, stride_C_BC)%len_type(NR) == 0;
+
+    /*
+     * Micro-kernel throughput relative to the scalar reference loops.
+     */
+    const double ukr_rate = std::max(1.0, MR*NR/scalar_ukr_tile);
+
+    const double flops = m*n*k*l;
+    const double size_C = m*n*l*rep_C;
+
+    if (len_A.empty() && len_B.empty() && len_C.empty() && 2*flops < small_tensor_flops)
+        return SMALL_TENSOR;
+
+    const bool ref_parallel = len_A.empty() && len_B.empty() && len_C.empty() &&
+                              (len_AB.empty() || len_ABC.empty());
+    const double nt_ref = ref_parallel ? nt : std::min(nt, l);
+
+    double cost_ref = (ref_flop_cost*flops*sum_A*sum_B + 2*size_C)/nt_ref;
+
+    double cost_blis, cost_blas;
+
+    if (len_AB.empty() && len_A.empty() && len_B.empty())
+    {
+        /*
+         * Outer products and weightings: the BLIS-based path is a single
+         * streaming pass over B and C.
+         */
+        cost_blis = blis_outer_setup_cost + (perm_B*n*l + 2*perm_C*size_C)/nt;
+        cost_blas = blas_outer_setup_cost +
+                    (perm_A*m*l + perm_B*n*l + 2*size_C +
+                     2*perm_C*size_C)/nt;
+    }
+    else
+    {
+        const double pack_A = m*k*l*sum_A*std::ceil(n/NC);
+        const double pack_B = k*n*l*sum_B;
+        const double update_C = size_C*std::ceil(k/KC);
+
+        cost_blis = blis_setup_cost + thread_setup_cost*nt +
+                    (2*(perm_A*pack_A + perm_B*pack_B) +
+                     2*(uniform_C ? 1 : scatter_C_factor)*perm_C*update_C +
+                     flops/ukr_rate)/nt;
+
+        cost_blas = blas_setup_cost + thread_setup_cost*nt +
+                    (perm_A*m*k*l*sum_A + perm_B*k*n*l*sum_B +
+                     (1 + 2*perm_C)*size_C +
+                     pack_A + pack_B + 2*update_C +
+                     flops/ukr_rate)/nt;
+    }
+
+    if (cost_ref <= cost_blis && cost_ref <= cost_blas) return REFERENCE;
+    if (cost_blas < cost_blis) return BLAS_BASED;
+    return BLIS_BASED;
+}
+
+template <typename T>
+void mult(const communicator& comm, const config& cfg, impl_t impl,
           const std::vector<len_type>& len_A,
           const std::vector<len_type>& len_B,
           const std::vector<len_type>& len_C,
@@ -655,9 +1689,43 @@ void mult(const communicator& comm, const config& cfg,
           const std::vector<stride_type>& stride_C_C,
           const std::vector<stride_type>& stride_C_AC,
           const std::vector<stride_type>& stride_C_BC,
-          const std::vector<stride_type>& stride_C_ABC)
+          const std::vector<stride_type>& stride_C_ABC,
+          const tblis_epilogue* epilogue,
+          const mult_layout<T>* layout)
 {
-    TBLIS_ASSERT(!conj_A && !conj_B && !conj_C);
+    if (impl == AUTOMATIC)
+        impl = select_impl<T>(cfg, comm.num_threads(),
+                              len_A, len_B, len_C,
+                              len_AB, len_AC, len_BC, len_ABC,
+                              stride_A_A, stride_A_AB, stride_A_AC, stride_A_ABC,
+                              stride_B_B, stride_B_AB, stride_B_BC, stride_B_ABC,
+                              stride_C_C, stride_C_AC, stride_C_BC, stride_C_ABC);
+
+    if (impl == SMALL_TENSOR)
+    {
+        if (len_A.empty() && len_B.empty() && len_C.empty())
+        {
+            if (comm.master())
+            {
+                mult_small(len_AB, len_AC, len_BC, len_ABC,
+                           alpha, conj_A, A, stride_A_AB, stride_A_AC, stride_A_ABC,
+                                  conj_B, B, stride_B_AB, stride_B_BC, stride_B_ABC,
+                            beta, conj_C, C, stride_C_AC, stride_C_BC, stride_C_ABC);
+            }
+
+            comm.barrier();
+
+            if (epilogue)
+                apply_epilogue(comm, len_AC+len_BC+len_ABC, C,
+                               stride_C_AC+stride_C_BC+stride_C_ABC, epilogue);
+
+            return;
+        }
+
+        impl = REFERENCE;
+    }
+
+    bool fused = false;
 
     if (len_A.empty() && len_B.empty() && len_C.empty() &&
         (len_AB.empty() || len_ABC.empty()))
@@ -669,16 +1737,23 @@ void mult(const communicator& comm, const config& cfg,
                 if (impl == REFERENCE)
                 {
                     outer_prod_ref(comm, cfg, len_AC, len_BC,
-                                   alpha, A, stride_A_AC,
-                                          B, stride_B_BC,
-                                    beta, C, stride_C_AC, stride_C_BC);
+                                   alpha, conj_A, A, stride_A_AC,
+                                          conj_B, B, stride_B_BC,
+                                    beta, conj_C, C, stride_C_AC, stride_C_BC);
                 }
-                else
+                else if (impl == BLAS_BASED)
                 {
                     outer_prod_blas(comm, cfg, len_AC, len_BC,
-                                    alpha, A, stride_A_AC,
-                                           B, stride_B_BC,
-                                     beta, C, stride_C_AC, stride_C_BC);
+                                    alpha, conj_A, A, stride_A_AC,
+                                           conj_B, B, stride_B_BC,
+                                     beta, conj_C, C, stride_C_AC, stride_C_BC);
+                }
+                else
+                {
+                    weight_blis(comm, cfg, len_AC, len_BC, {},
+                                alpha, conj_A, A, stride_A_AC, {},
+                                       conj_B, B, stride_B_BC, {},
+                                 beta, conj_C, C, stride_C_AC, stride_C_BC, {});
                 }
             }
             else
@@ -686,16 +1761,23 @@ void mult(const communicator& comm, const config& cfg,
                 if (impl == REFERENCE)
                 {
                     weight_ref(comm, cfg, len_AC, len_BC, len_ABC,
-                               alpha, A, stride_A_AC, stride_A_ABC,
-                                      B, stride_B_BC, stride_B_ABC,
-                                beta, C, stride_C_AC, stride_C_BC, stride_C_ABC);
+                               alpha, conj_A, A, stride_A_AC, stride_A_ABC,
+                                      conj_B, B, stride_B_BC, stride_B_ABC,
+                                beta, conj_C, C, stride_C_AC, stride_C_BC, stride_C_ABC);
                 }
-                else
+                else if (impl == BLAS_BASED)
                 {
                     weight_blas(comm, cfg, len_AC, len_BC, len_ABC,
-                                alpha, A, stride_A_AC, stride_A_ABC,
-                                       B, stride_B_BC, stride_B_ABC,
-                                 beta, C, stride_C_AC, stride_C_BC, stride_C_ABC);
+                                alpha, conj_A, A, stride_A_AC, stride_A_ABC,
+                                       conj_B, B, stride_B_BC, stride_B_ABC,
+                                 beta, conj_C, C, stride_C_AC, stride_C_BC, stride_C_ABC);
+                }
+                else
+                {
+                    weight_blis(comm, cfg, len_AC, len_BC, len_ABC,
+                                alpha, conj_A, A, stride_A_AC, stride_A_ABC,
+                                       conj_B, B, stride_B_BC, stride_B_ABC,
+                                 beta, conj_C, C, stride_C_AC, stride_C_BC, stride_C_ABC);
                 }
             }
         }
@@ -704,23 +1786,25 @@ void mult(const communicator& comm, const config& cfg,
             if (impl == REFERENCE)
             {
                 contract_ref(comm, cfg, len_AB, len_AC, len_BC,
-                             alpha, A, stride_A_AB, stride_A_AC,
-                                    B, stride_B_AB, stride_B_BC,
-                              beta, C, stride_C_AC, stride_C_BC);
+                             alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                    conj_B, B, stride_B_AB, stride_B_BC,
+                              beta, conj_C, C, stride_C_AC, stride_C_BC);
             }
             else if (impl == BLAS_BASED)
             {
                 contract_blas(comm, cfg, len_AB, len_AC, len_BC,
-                              alpha, A, stride_A_AB, stride_A_AC,
-                                     B, stride_B_AB, stride_B_BC,
-                               beta, C, stride_C_AC, stride_C_BC);
+                              alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                     conj_B, B, stride_B_AB, stride_B_BC,
+                               beta, conj_C, C, stride_C_AC, stride_C_BC);
             }
             else
             {
                 contract_blis(comm, cfg, len_AB, len_AC, len_BC,
-                              alpha, A, stride_A_AB, stride_A_AC,
-                                     B, stride_B_AB, stride_B_BC,
-                               beta, C, stride_C_AC, stride_C_BC);
+                              alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                     conj_B, B, stride_B_AB, stride_B_BC,
+                               beta, conj_C, C, stride_C_AC, stride_C_BC,
+                               epilogue, layout);
+                fused = true;
             }
         }
     }
@@ -730,31 +1814,71 @@ void mult(const communicator& comm, const config& cfg,
         {
             mult_ref(comm, cfg, len_A, len_B, len_C,
                      len_AB, len_AC, len_BC, len_ABC,
-                     alpha, A, stride_A_A, stride_A_AB,
-                               stride_A_AC, stride_A_ABC,
-                            B, stride_B_B, stride_B_AB,
-                               stride_B_BC, stride_B_ABC,
-                      beta, C, stride_C_C, stride_C_AC,
-                               stride_C_BC, stride_C_ABC);
+                     alpha, conj_A, A, stride_A_A, stride_A_AB,
+                                       stride_A_AC, stride_A_ABC,
+                            conj_B, B, stride_B_B, stride_B_AB,
+                                       stride_B_BC, stride_B_ABC,
+                      beta, conj_C, C, stride_C_C, stride_C_AC,
+                                       stride_C_BC, stride_C_ABC);
         }
-        else
+        else if (impl == BLAS_BASED)
         {
             mult_blas(comm, cfg, len_A, len_B, len_C,
                       len_AB, len_AC, len_BC, len_ABC,
-                      alpha, A, stride_A_A, stride_A_AB,
-                                stride_A_AC, stride_A_ABC,
-                             B, stride_B_B, stride_B_AB,
-                                stride_B_BC, stride_B_ABC,
-                       beta, C, stride_C_C, stride_C_AC,
-                                stride_C_BC, stride_C_ABC);
+                      alpha, conj_A, A, stride_A_A, stride_A_AB,
+                                        stride_A_AC, stride_A_ABC,
+                             conj_B, B, stride_B_B, stride_B_AB,
+                                        stride_B_BC, stride_B_ABC,
+                       beta, conj_C, C, stride_C_C, stride_C_AC,
+                                        stride_C_BC, stride_C_ABC);
+        }
+        else
+        {
+            mult_blis(comm, cfg, len_A, len_B, len_C,
+                      len_AB, len_AC, len_BC, len_ABC,
+                      alpha, conj_A, A, stride_A_A, stride_A_AB,
+                                        stride_A_AC, stride_A_ABC,
+                             conj_B, B, stride_B_B, stride_B_AB,
+                                        stride_B_BC, stride_B_ABC,
+                       beta, conj_C, C, stride_C_C, stride_C_AC,
+                                        stride_C_BC, stride_C_ABC, epilogue, layout);
+            fused = true;
         }
     }
 
     comm.barrier();
+
+    /*
+     * The BLIS-based implementations apply the epilogue to each tile of C
+     * as it is finished; otherwise it takes a separate pass over C.
+     */
+    if (epilogue && !fused)
+        apply_epilogue(comm, len_C+len_AC+len_BC+len_ABC, C,
+                       stride_C_C+stride_C_AC+stride_C_BC+stride_C_ABC, epilogue);
 }
 
 #define FOREACH_TYPE(T) \
-template void mult(const communicator& comm, const config& cfg, \
+template impl_t select_impl<T>(const config& cfg, unsigned nthread, \
+                               const std::vector<len_type>& len_A, \
+                               const std::vector<len_type>& len_B, \
+                               const std::vector<len_type>& len_C, \
+                               const std::vector<len_type>& len_AB, \
+                               const std::vector<len_type>& len_AC, \
+                               const std::vector<len_type>& len_BC, \
+                               const std::vector<len_type>& len_ABC, \
+                               const std::vector<stride_type>& stride_A_A, \
+                               const std::vector<stride_type>& stride_A_AB, \
+                               const std::vector<stride_type>& stride_A_AC, \
+                               const std::vector<stride_type>& stride_A_ABC, \
+                               const std::vector<stride_type>& stride_B_B, \
+                               const std::vector<stride_type>& stride_B_AB, \
+                               const std::vector<stride_type>& stride_B_BC, \
+                               const std::vector<stride_type>& stride_B_ABC, \
+                               const std::vector<stride_type>& stride_C_C, \
+                               const std::vector<stride_type>& stride_C_AC, \
+                               const std::vector<stride_type>& stride_C_BC, \
+                               const std::vector<stride_type>& stride_C_ABC); \
+template void mult(const communicator& comm, const config& cfg, impl_t impl, \
                    const std::vector<len_type>& len_A, \
                    const std::vector<len_type>& len_B, \
                    const std::vector<len_type>& len_C, \
@@ -776,7 +1900,13 @@ template void mult(const communicator& comm, const config& cfg, \
                    const std::vector<stride_type>& stride_C_C, \
                    const std::vector<stride_type>& stride_C_AC, \
                    const std::vector<stride_type>& stride_C_BC, \
-                   const std::vector<stride_type>& stride_C_ABC);
+                   const std::vector<stride_type>& stride_C_ABC, \
+                   const tblis_epilogue* epilogue, \
+                   const mult_layout<T>* layout); \
+template void apply_epilogue(const communicator& comm, \
+                             const std::vector<len_type>& len, \
+                             T* C, const std::vector<stride_type>& stride, \
+                             const tblis_epilogue* epilogue);
 #include "configs/foreach_type.h"
 
 }
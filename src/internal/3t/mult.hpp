@@ -4,17 +4,161 @@
 #include "util/thread.h"
 #include "util/basic_types.h"
 #include "configs/configs.hpp"
+#include "util/gemm_thread.hpp"
+#include "matrix/tensor_matrix.hpp"
+#include "memory/memory_pool.hpp"
 
 namespace tblis
 {
 namespace internal
 {
 
-enum impl_t {BLIS_BASED, BLAS_BASED, REFERENCE};
+/*
+ * The implementation used when none is requested explicitly. The default,
+ * AUTOMATIC, chooses one for each contraction with select_impl.
+ */
 extern impl_t impl;
 
+/*
+ * Parameters of the cost model in select_impl. Costs are in units of one
+ * scalar multiply-add or one (cache-friendly) memory access.
+ */
+
+/* Below this many flops, starting threads and building the control tree dominate. */
+constexpr double small_tensor_flops = 1e5;
+
+/* A micro-tile (MR*NR) this small runs no faster than the scalar loops. */
+constexpr double scalar_ukr_tile = 8;
+
+/* A tensor without a unit-stride index is accessed a cache line per element. */
+constexpr double no_unit_stride_factor = 2;
+
+/* The reference loops are neither vectorized nor blocked for cache. */
+constexpr double ref_flop_cost = 4;
+
+/* Setup of the BLIS-based path: scatter vectors and the control tree. */
+constexpr double blis_setup_cost = 2e4;
+
+/* Setup of the BLAS-based path: temporaries and the extra permutations. */
+constexpr double blas_setup_cost = 4e4;
+
+/* Both outer product paths skip packing A, so their setup is much cheaper. */
+constexpr double blis_outer_setup_cost = 1e3;
+constexpr double blas_outer_setup_cost = 1e4;
+
+/* Starting and synchronizing each additional thread. */
+constexpr double thread_setup_cost = 2e3;
+
+/* Updating C through a temporary micro-tile costs three times as much as in place. */
+constexpr double scatter_C_factor = 3;
+
+template <typename T>
+impl_t select_impl(const config& cfg, unsigned nthread,
+                   const std::vector<len_type>& len_A,
+                   const std::vector<len_type>& len_B,
+                   const std::vector<len_type>& len_C,
+                   const std::vector<len_type>& len_AB,
+                   const std::vector<len_type>& len_AC,
+                   const std::vector<len_type>& len_BC,
+                   const std::vector<len_type>& len_ABC,
+                   const std::vector<stride_type>& stride_A_A,
+                   const std::vector<stride_type>& stride_A_AB,
+                   const std::vector<stride_type>& stride_A_AC,
+                   const std::vector<stride_type>& stride_A_ABC,
+                   const std::vector<stride_type>& stride_B_B,
+                   const std::vector<stride_type>& stride_B_AB,
+                   const std::vector<stride_type>& stride_B_BC,
+                   const std::vector<stride_type>& stride_B_ABC,
+                   const std::vector<stride_type>& stride_C_C,
+                   const std::vector<stride_type>& stride_C_AC,
+                   const std::vector<stride_type>& stride_C_BC,
+                   const std::vector<stride_type>& stride_C_ABC);
+
+/*
+ * The parts of the BLIS-based implementation which only depend on the lengths
+ * and strides of the operands, the configuration, and the number of threads:
+ * A, B, and C as matrices (with the indices sorted by stride, and transposed
+ * if C^T = B^T*A^T is computed instead), the offsets of the indices which
+ * appear in only one operand, the scatter vectors, and the thread
+ * configuration. mult computes these on every call unless it is given a
+ * layout made ahead of time by init_mult_layout (as a plan does), in which
+ * case only the data pointers and scalars change from call to call.
+ */
+template <typename T>
+struct mult_layout
+{
+    bool transpose = false;
+    tensor_matrix<T> at, bt, ct;
+    std::vector<stride_type> extra;
+    MemoryPool::Block scat_A, scat_B, scat_C;
+    unsigned ngang = 1;
+    gemm_thread_config tc = {1, 1, 1, 1};
+
+    /*
+     * With split-K, the gangs other than the first each compute their part
+     * of the product into a private copy of C laid out like this.
+     */
+    tensor_matrix<T> pt;
+    std::vector<stride_type> stride_P;
+    stride_type size_P = 0;
+};
+
+/*
+ * Compute the layout of a product with the given lengths and strides for a
+ * team of nthread threads. Shapes which do not use a layout (because they
+ * are empty or are weightings or outer products) leave it unchanged.
+ */
 template <typename T>
-void mult(const communicator& comm, const config& cfg,
+void init_mult_layout(const communicator& comm, const config& cfg,
+                      unsigned nthread, mult_layout<T>& layout,
+                      const std::vector<len_type>& len_A,
+                      const std::vector<len_type>& len_B,
+                      const std::vector<len_type>& len_C,
+                      const std::vector<len_type>& len_AB,
+                      const std::vector<len_type>& len_AC,
+                      const std::vector<len_type>& len_BC,
+                      const std::vector<len_type>& len_ABC,
+                      const std::vector<stride_type>& stride_A_A,
+                      const std::vector<stride_type>& stride_A_AB,
+                      const std::vector<stride_type>& stride_A_AC,
+                      const std::vector<stride_type>& stride_B_B,
+                      const std::vector<stride_type>& stride_B_AB,
+                      const std::vector<stride_type>& stride_B_BC,
+                      const std::vector<stride_type>& stride_C_C,
+                      const std::vector<stride_type>& stride_C_AC,
+                      const std::vector<stride_type>& stride_C_BC);
+
+/*
+ * C = beta*C + sum_i alpha_i*A_i*B_i, where each term contracts over its own
+ * indices but all terms share the row (AC) and column (BC) indices of C. The
+ * terms are concatenated along k, so that C is only updated once for each
+ * block of k and not once per term.
+ */
+template <typename T>
+void mult_sum(const communicator& comm, const config& cfg,
+              const std::vector<std::vector<len_type>>& len_AB,
+              const std::vector<len_type>& len_AC,
+              const std::vector<len_type>& len_BC,
+              const std::vector<T>& alpha,
+              const std::vector<bool>& conj_A,
+              const std::vector<const T*>& A,
+              const std::vector<std::vector<stride_type>>& stride_A_AB,
+              const std::vector<std::vector<stride_type>>& stride_A_AC,
+              const std::vector<bool>& conj_B,
+              const std::vector<const T*>& B,
+              const std::vector<std::vector<stride_type>>& stride_B_AB,
+              const std::vector<std::vector<stride_type>>& stride_B_BC,
+              T  beta, bool conj_C, T* C,
+              const std::vector<stride_type>& stride_C_AC,
+              const std::vector<stride_type>& stride_C_BC);
+
+/*
+ * If layout is not null, it must have been made by init_mult_layout for the
+ * same lengths and strides and for the number of threads in comm. It is only
+ * used by the BLIS-based implementation.
+ */
+template <typename T>
+void mult(const communicator& comm, const config& cfg, impl_t impl,
           const std::vector<len_type>& len_A,
           const std::vector<len_type>& len_B,
           const std::vector<len_type>& len_C,
@@ -36,7 +180,19 @@ void mult(const communicator& comm, const config& cfg,
           const std::vector<stride_type>& stride_C_C,
           const std::vector<stride_type>& stride_C_AC,
           const std::vector<stride_type>& stride_C_BC,
-          const std::vector<stride_type>& stride_C_ABC);
+          const std::vector<stride_type>& stride_C_ABC,
+          const tblis_epilogue* epilogue,
+          const mult_layout<T>* layout);
+
+/*
+ * Apply an epilogue to each element of C, for when it could not be fused
+ * into the computation of C itself.
+ */
+template <typename T>
+void apply_epilogue(const communicator& comm,
+                    const std::vector<len_type>& len,
+                    T* C, const std::vector<stride_type>& stride,
+                    const tblis_epilogue* epilogue);
 
 }
 }
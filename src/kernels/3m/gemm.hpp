@@ -74,6 +74,203 @@ void gemm_ukr_def(stride_type k,
     }
 }
 
+/*
+ * The width in bytes of the widest vector registers available for the target
+ * of the current translation unit.
+ */
+#if defined(__AVX512F__)
+#define TBLIS_VECTOR_BYTES 64
+#elif defined(__AVX__)
+#define TBLIS_VECTOR_BYTES 32
+#else
+#define TBLIS_VECTOR_BYTES 16
+#endif
+
+template <typename T, int N>
+struct vector_type
+{
+    typedef T type __attribute__((vector_size(N*sizeof(T))));
+};
+
+/*
+ * A portable micro-kernel for real types, written with the GCC/clang vector
+ * extensions. MR must be a multiple of the vector length, and the MR/VL x NR
+ * vector accumulators (plus MR/VL vectors of A and one of B) should fit in
+ * the register file, otherwise the compiler will spill them.
+ */
+template <typename Config, typename T>
+void gemm_ukr_vec(stride_type k,
+                  const T* TBLIS_RESTRICT alpha,
+                  const T* TBLIS_RESTRICT p_a, const T* TBLIS_RESTRICT p_b,
+                  const T* TBLIS_RESTRICT beta,
+                  T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    constexpr len_type MR = Config::template gemm_mr<T>::def;
+    constexpr len_type NR = Config::template gemm_nr<T>::def;
+    constexpr len_type VL = TBLIS_VECTOR_BYTES/sizeof(T);
+    constexpr len_type MV = MR/VL;
+
+    static_assert(MR%VL == 0 && !Config::template gemm_row_major<T>::value,
+                  "Invalid blocksizes for the vector micro-kernel");
+
+    typedef typename vector_type<T,VL>::type V;
+
+    V ab[NR][MV] = {};
+
+    while (k --> 0)
+    {
+        V a[MV];
+
+        for (len_type i = 0;i < MV;i++)
+            memcpy(&a[i], p_a + i*VL, sizeof(V));
+
+        for (len_type j = 0;j < NR;j++)
+        {
+            for (len_type i = 0;i < MV;i++)
+            {
+                ab[j][i] += a[i]*p_b[j];
+            }
+        }
+
+        p_a += MR;
+        p_b += NR;
+    }
+
+    if (rs_c == 1)
+    {
+        for (len_type j = 0;j < NR;j++)
+        {
+            for (len_type i = 0;i < MV;i++)
+            {
+                V c = (*alpha)*ab[j][i];
+
+                if (*beta != T(0))
+                {
+                    V c_old;
+                    memcpy(&c_old, p_c + i*VL + j*cs_c, sizeof(V));
+                    c += (*beta)*c_old;
+                }
+
+                memcpy(p_c + i*VL + j*cs_c, &c, sizeof(V));
+            }
+        }
+    }
+    else
+    {
+        T p_ab[MR*NR] __attribute__((aligned(64)));
+        memcpy(p_ab, ab, sizeof(p_ab));
+
+        if (*beta == T(0))
+        {
+            for (len_type j = 0;j < NR;j++)
+            {
+                for (len_type i = 0;i < MR;i++)
+                {
+                    p_c[i*rs_c + j*cs_c] = (*alpha)*p_ab[i + MR*j];
+                }
+            }
+        }
+        else
+        {
+            for (len_type j = 0;j < NR;j++)
+            {
+                for (len_type i = 0;i < MR;i++)
+                {
+                    p_c[i*rs_c + j*cs_c] = (*alpha)*p_ab[i + MR*j] +
+                                           (*beta)*p_c[i*rs_c + j*cs_c];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * The 1m method: compute a complex micro-tile with the real micro-kernel of
+ * the same config, on packed micro-panels which have been reorganized so
+ * that the real product is the complex one. One micro-panel is packed in the
+ * "1e" format, where each complex element a is followed (MR elements later)
+ * by i*a, so that in real terms it becomes [ar -ai; ai ar]. The other is
+ * packed in the "1r" format, where the real and imaginary parts of each
+ * column of the micro-panel are stored separately. A is packed as 1e for
+ * column-major kernels and B for row-major ones, so that the real micro-tile
+ * is the complex micro-tile with its real and imaginary parts interleaved.
+ *
+ * The 1e micro-panel is thus twice the size of a complex micro-panel and the
+ * real kernel runs over 2*k, i.e. the complex blocksizes along the 1e
+ * dimension are half of the real ones, with an extent equal to the real one.
+ */
+template <typename Config, typename T>
+void gemm_ukr_1m(stride_type k,
+                 const T* TBLIS_RESTRICT alpha,
+                 const T* TBLIS_RESTRICT p_a, const T* TBLIS_RESTRICT p_b,
+                 const T* TBLIS_RESTRICT beta,
+                 T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    typedef real_type_t<T> U;
+
+    constexpr len_type MR = Config::template gemm_mr<U>::def;
+    constexpr len_type NR = Config::template gemm_nr<U>::def;
+    constexpr len_type MRC = Config::template gemm_mr<T>::def;
+    constexpr len_type NRC = Config::template gemm_nr<T>::def;
+    constexpr bool row_major = Config::template gemm_row_major<U>::value;
+    constexpr gemm_ukr_t<U> ukr = Config::template gemm_ukr<U>::value;
+
+    static_assert(Config::template gemm_row_major<T>::value == row_major &&
+                  MRC == (row_major ? MR : MR/2) &&
+                  NRC == (row_major ? NR/2 : NR) &&
+                  Config::template gemm_mr<T>::extent == (row_major ? MR : MR/2)*(row_major ? 1 : 2) &&
+                  Config::template gemm_nr<T>::extent == (row_major ? NR/2 : NR)*(row_major ? 2 : 1),
+                  "Invalid blocksizes for the 1m method");
+
+    const U* p_ar = reinterpret_cast<const U*>(p_a);
+    const U* p_br = reinterpret_cast<const U*>(p_b);
+
+    if (alpha->imag() == U(0) && beta->imag() == U(0) &&
+        (row_major ? cs_c == 1 : rs_c == 1))
+    {
+        U alpha_r = alpha->real();
+        U beta_r = beta->real();
+
+        ukr(2*k, &alpha_r, p_ar, p_br, &beta_r, reinterpret_cast<U*>(p_c),
+            (row_major ? 2*rs_c : 1), (row_major ? 1 : 2*cs_c));
+    }
+    else
+    {
+        U p_ab[MR*NR] __attribute__((aligned(64)));
+        static constexpr U one = U(1);
+        static constexpr U zero = U(0);
+
+        ukr(2*k, &one, p_ar, p_br, &zero, p_ab,
+            (row_major ? NR : 1), (row_major ? 1 : MR));
+
+        const T* p_abc = reinterpret_cast<const T*>(p_ab);
+        constexpr len_type rs_ab = (row_major ? NRC : 1);
+        constexpr len_type cs_ab = (row_major ? 1 : MRC);
+
+        if (*beta == T(0))
+        {
+            for (len_type j = 0;j < NRC;j++)
+            {
+                for (len_type i = 0;i < MRC;i++)
+                {
+                    p_c[i*rs_c + j*cs_c] = (*alpha)*p_abc[i*rs_ab + j*cs_ab];
+                }
+            }
+        }
+        else
+        {
+            for (len_type j = 0;j < NRC;j++)
+            {
+                for (len_type i = 0;i < MRC;i++)
+                {
+                    p_c[i*rs_c + j*cs_c] = (*alpha)*p_abc[i*rs_ab + j*cs_ab] +
+                                           (*beta)*p_c[i*rs_c + j*cs_c];
+                }
+            }
+        }
+    }
+}
+
 #define EXTERN_PACK_NN_UKR(T, name) \
 extern void name(tblis::len_type m, tblis::len_type k, \
                  const T* p_a, tblis::stride_type rs_a, \
@@ -395,6 +592,192 @@ void pack_sb_ukr_def(len_type m, len_type k,
     }
 }
 
+/*
+ * Update kernels: C = AB + beta*C for a (possibly partial) m x n micro-tile
+ * AB computed into a temporary, where the rows and/or columns of C may be
+ * given by scatter vectors. C is not read if beta is zero.
+ */
+
+#define EXTERN_UPDATE_NN_UKR(T, name) \
+extern void name(tblis::len_type m, tblis::len_type n, \
+                 const T* p_ab, tblis::stride_type rs_ab, \
+                                tblis::stride_type cs_ab, \
+                 const T* beta, \
+                 T* p_c, tblis::stride_type rs_c, \
+                         tblis::stride_type cs_c);
+
+template <typename T>
+using update_nn_ukr_t =
+void (*)(len_type m, len_type n,
+         const T* p_ab, stride_type rs_ab, stride_type cs_ab,
+         const T* beta,
+         T* p_c, stride_type rs_c, stride_type cs_c);
+
+#define EXTERN_UPDATE_SN_UKR(T, name) \
+extern void name(tblis::len_type m, tblis::len_type n, \
+                 const T* p_ab, tblis::stride_type rs_ab, \
+                                tblis::stride_type cs_ab, \
+                 const T* beta, \
+                 T* p_c, const tblis::stride_type* rscat_c, \
+                         tblis::stride_type cs_c);
+
+template <typename T>
+using update_sn_ukr_t =
+void (*)(len_type m, len_type n,
+         const T* p_ab, stride_type rs_ab, stride_type cs_ab,
+         const T* beta,
+         T* p_c, const stride_type* rscat_c, stride_type cs_c);
+
+#define EXTERN_UPDATE_NS_UKR(T, name) \
+extern void name(tblis::len_type m, tblis::len_type n, \
+                 const T* p_ab, tblis::stride_type rs_ab, \
+                                tblis::stride_type cs_ab, \
+                 const T* beta, \
+                 T* p_c, tblis::stride_type rs_c, \
+                         const tblis::stride_type* cscat_c);
+
+template <typename T>
+using update_ns_ukr_t =
+void (*)(len_type m, len_type n,
+         const T* p_ab, stride_type rs_ab, stride_type cs_ab,
+         const T* beta,
+         T* p_c, stride_type rs_c, const stride_type* cscat_c);
+
+#define EXTERN_UPDATE_SS_UKR(T, name) \
+extern void name(tblis::len_type m, tblis::len_type n, \
+                 const T* p_ab, tblis::stride_type rs_ab, \
+                                tblis::stride_type cs_ab, \
+                 const T* beta, \
+                 T* p_c, const tblis::stride_type* rscat_c, \
+                         const tblis::stride_type* cscat_c);
+
+template <typename T>
+using update_ss_ukr_t =
+void (*)(len_type m, len_type n,
+         const T* p_ab, stride_type rs_ab, stride_type cs_ab,
+         const T* beta,
+         T* p_c, const stride_type* rscat_c, const stride_type* cscat_c);
+
+template <typename Config, typename T>
+void update_nn_ukr_def(len_type m, len_type n,
+                       const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+                       const T* TBLIS_RESTRICT beta,
+                       T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    if (*beta == T(0))
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+            }
+        }
+    }
+    else
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] +
+                                       (*beta)*p_c[i*rs_c + j*cs_c];
+            }
+        }
+    }
+}
+
+template <typename Config, typename T>
+void update_sn_ukr_def(len_type m, len_type n,
+                       const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+                       const T* TBLIS_RESTRICT beta,
+                       T* TBLIS_RESTRICT p_c,
+                       const stride_type* TBLIS_RESTRICT rscat_c, stride_type cs_c)
+{
+    if (*beta == T(0))
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[rscat_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+            }
+        }
+    }
+    else
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[rscat_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] +
+                                           (*beta)*p_c[rscat_c[i] + j*cs_c];
+            }
+        }
+    }
+}
+
+template <typename Config, typename T>
+void update_ns_ukr_def(len_type m, len_type n,
+                       const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+                       const T* TBLIS_RESTRICT beta,
+                       T* TBLIS_RESTRICT p_c,
+                       stride_type rs_c, const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    if (*beta == T(0))
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[i*rs_c + cscat_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+            }
+        }
+    }
+    else
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[i*rs_c + cscat_c[j]] = p_ab[i*rs_ab + j*cs_ab] +
+                                           (*beta)*p_c[i*rs_c + cscat_c[j]];
+            }
+        }
+    }
+}
+
+template <typename Config, typename T>
+void update_ss_ukr_def(len_type m, len_type n,
+                       const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
+                       const T* TBLIS_RESTRICT beta,
+                       T* TBLIS_RESTRICT p_c,
+                       const stride_type* TBLIS_RESTRICT rscat_c,
+                       const stride_type* TBLIS_RESTRICT cscat_c)
+{
+    if (*beta == T(0))
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[rscat_c[i] + cscat_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+            }
+        }
+    }
+    else
+    {
+        for (len_type j = 0;j < n;j++)
+        {
+            for (len_type i = 0;i < m;i++)
+            {
+                p_c[rscat_c[i] + cscat_c[j]] = p_ab[i*rs_ab + j*cs_ab] +
+                                               (*beta)*p_c[rscat_c[i] + cscat_c[j]];
+            }
+        }
+    }
+}
+
 }
 
 #endif
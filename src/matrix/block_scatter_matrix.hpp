@@ -28,6 +28,8 @@ class block_scatter_matrix
         std::array<scatter_type, 2> block_scatter_;
         std::array<scatter_type, 2> scatter_;
         std::array<len_type, 2> block_size_;
+        len_type extra_len_;
+        scatter_type extra_offsets_;
 
     public:
         block_scatter_matrix()
@@ -55,6 +57,8 @@ class block_scatter_matrix
             block_scatter_[1] = nullptr;
             scatter_[0] = nullptr;
             scatter_[1] = nullptr;
+            extra_len_ = 0;
+            extra_offsets_ = nullptr;
         }
 
         void reset(const block_scatter_matrix& other)
@@ -66,6 +70,8 @@ class block_scatter_matrix
             block_scatter_[1] = other.block_scatter_[1];
             scatter_[0] = other.scatter_[0];
             scatter_[1] = other.scatter_[1];
+            extra_len_ = other.extra_len_;
+            extra_offsets_ = other.extra_offsets_;
         }
 
         void reset(len_type m, len_type n, pointer p,
@@ -81,6 +87,8 @@ class block_scatter_matrix
             scatter_[1] = cscat;
             block_size_[0] = MB;
             block_size_[1] = NB;
+            extra_len_ = 0;
+            extra_offsets_ = nullptr;
 
             for (len_type i = 0;i < m;i += MB)
             {
@@ -140,6 +148,22 @@ class block_scatter_matrix
             return block_scatter_[dim];
         }
 
+        len_type extra_length() const
+        {
+            return extra_len_;
+        }
+
+        scatter_type extra_offsets() const
+        {
+            return extra_offsets_;
+        }
+
+        void extra_offsets(len_type len, scatter_type offsets)
+        {
+            extra_len_ = len;
+            extra_offsets_ = offsets;
+        }
+
         void shift(unsigned dim, len_type n)
         {
             TBLIS_ASSERT(dim < 2);
@@ -0,0 +1,195 @@
+#ifndef _TBLIS_MULTI_TENSOR_MATRIX_HPP_
+#define _TBLIS_MULTI_TENSOR_MATRIX_HPP_
+
+#include "util/basic_types.h"
+
+#include "memory/alignment.hpp"
+
+#include "matrix/tensor_matrix.hpp"
+#include "matrix/block_scatter_matrix.hpp"
+
+namespace tblis
+{
+
+/*
+ * Several tensor matrices concatenated along one dimension (the "cat"
+ * dimension), e.g. the A or B operands of a sum of contractions into the same
+ * C, concatenated along k. Each term carries a scaling factor and
+ * conjugation flag which are applied when it is packed. The terms must all
+ * have the same length along the other dimension.
+ */
+template <typename T>
+class multi_tensor_matrix
+{
+    public:
+        struct term
+        {
+            tensor_matrix<T> matrix;
+            T alpha;
+            bool conj;
+        };
+
+    protected:
+        std::vector<term> terms_;
+        unsigned cat_dim_;
+        std::array<len_type, 2> len_;
+        std::array<len_type, 2> offset_;
+
+    public:
+        explicit multi_tensor_matrix(unsigned cat_dim)
+        : cat_dim_(cat_dim), len_{{0, 0}}, offset_{{0, 0}}
+        {
+            TBLIS_ASSERT(cat_dim < 2);
+        }
+
+        multi_tensor_matrix& operator=(const multi_tensor_matrix& other) = delete;
+
+        void push_back(tensor_matrix<T> matrix, T alpha, bool conj)
+        {
+            TBLIS_ASSERT(offset_[0] == 0 && offset_[1] == 0);
+            TBLIS_ASSERT(terms_.empty() ||
+                         matrix.length(!cat_dim_) == len_[!cat_dim_]);
+
+            len_[!cat_dim_] = matrix.length(!cat_dim_);
+            len_[cat_dim_] += matrix.length(cat_dim_);
+            terms_.push_back(term{std::move(matrix), alpha, conj});
+        }
+
+        std::vector<term>& terms()
+        {
+            return terms_;
+        }
+
+        unsigned cat_dim() const
+        {
+            return cat_dim_;
+        }
+
+        void transpose()
+        {
+            using std::swap;
+            swap(len_[0], len_[1]);
+            swap(offset_[0], offset_[1]);
+            cat_dim_ = !cat_dim_;
+            for (auto& t : terms_) t.matrix.transpose();
+        }
+
+        len_type length(unsigned dim) const
+        {
+            TBLIS_ASSERT(dim < 2);
+            return len_[dim];
+        }
+
+        len_type length(unsigned dim, len_type m)
+        {
+            TBLIS_ASSERT(dim < 2);
+            std::swap(m, len_[dim]);
+            return m;
+        }
+
+        void shift(unsigned dim, len_type n)
+        {
+            TBLIS_ASSERT(dim < 2);
+            offset_[dim] += n;
+        }
+
+        void shift_down(unsigned dim)
+        {
+            shift(dim, len_[dim]);
+        }
+
+        void shift_up(unsigned dim)
+        {
+            shift(dim, -len_[dim]);
+        }
+
+        /*
+         * Call f(segment, offset, alpha, conj) for each term which overlaps
+         * the current block, where segment is the overlapping part of that
+         * term and offset is its position along the cat dimension relative to
+         * the start of the block.
+         */
+        template <typename Func>
+        void for_each_segment(Func&& f) const
+        {
+            unsigned d = cat_dim_;
+            len_type start = 0;
+
+            for (auto& t : terms_)
+            {
+                len_type len = t.matrix.length(d);
+                len_type first = std::max(start, offset_[d]);
+                len_type last = std::min(start+len, offset_[d]+len_[d]);
+
+                if (first < last)
+                {
+                    tensor_matrix<T> segment(t.matrix);
+                    segment.shift(d, first-start);
+                    segment.length(d, last-first);
+                    segment.shift(!d, offset_[!d]);
+                    segment.length(!d, len_[!d]);
+
+                    f(segment, first-offset_[d], t.alpha, t.conj);
+                }
+
+                start += len;
+            }
+        }
+};
+
+/*
+ * The matrified and blocked counterpart of multi_tensor_matrix: one
+ * block_scatter_matrix per term overlapping the current block, along with
+ * its offset along the cat dimension and the scaling factor and conjugation
+ * flag to apply.
+ */
+template <typename T>
+class multi_block_scatter_matrix
+{
+    public:
+        struct segment
+        {
+            len_type offset;
+            block_scatter_matrix<T> matrix;
+            T alpha;
+            bool conj;
+        };
+
+    protected:
+        std::vector<segment> segments_;
+        unsigned cat_dim_;
+        std::array<len_type, 2> len_;
+
+    public:
+        multi_block_scatter_matrix(len_type m, len_type n, unsigned cat_dim)
+        : cat_dim_(cat_dim), len_{{m, n}}
+        {
+            TBLIS_ASSERT(cat_dim < 2);
+        }
+
+        void push_back(len_type offset, const block_scatter_matrix<T>& matrix,
+                       T alpha, bool conj)
+        {
+            segments_.push_back(segment{offset, matrix, alpha, conj});
+        }
+
+        const std::vector<segment>& segments() const
+        {
+            return segments_;
+        }
+
+        unsigned cat_dim() const
+        {
+            return cat_dim_;
+        }
+
+        len_type length(unsigned dim) const
+        {
+            TBLIS_ASSERT(dim < 2);
+            return len_[dim];
+        }
+};
+
+}
+
+#endif
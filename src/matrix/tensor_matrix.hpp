@@ -25,6 +25,11 @@ class tensor_matrix
         std::array<len_type, 2> leading_len_;
         std::array<stride_type, 2> leading_stride_;
         std::array<MArray::viterator<>, 2> iterator_;
+        len_type extra_len_;
+        scatter_type extra_offsets_;
+        std::array<scatter_type, 2> scatter_;
+        std::array<scatter_type, 2> block_scatter_;
+        std::array<len_type, 2> block_size_;
 
     public:
         tensor_matrix()
@@ -75,6 +80,14 @@ class tensor_matrix
             leading_stride_[1] = 0;
             iterator_[0] = MArray::viterator<>();
             iterator_[1] = MArray::viterator<>();
+            extra_len_ = 0;
+            extra_offsets_ = nullptr;
+            scatter_[0] = nullptr;
+            scatter_[1] = nullptr;
+            block_scatter_[0] = nullptr;
+            block_scatter_[1] = nullptr;
+            block_size_[0] = 0;
+            block_size_[1] = 0;
         }
 
         void reset(const tensor_matrix& other)
@@ -90,6 +103,11 @@ class tensor_matrix
             leading_stride_[1] = other.leading_stride_[1];
             iterator_[0] = other.iterator_[0];
             iterator_[1] = other.iterator_[1];
+            extra_len_ = other.extra_len_;
+            extra_offsets_ = other.extra_offsets_;
+            scatter_ = other.scatter_;
+            block_scatter_ = other.block_scatter_;
+            block_size_ = other.block_size_;
         }
 
         void reset(tensor_matrix&& other)
@@ -105,6 +123,11 @@ class tensor_matrix
             leading_stride_[1] = other.leading_stride_[1];
             iterator_[0] = std::move(other.iterator_[0]);
             iterator_[1] = std::move(other.iterator_[1]);
+            extra_len_ = other.extra_len_;
+            extra_offsets_ = other.extra_offsets_;
+            scatter_ = other.scatter_;
+            block_scatter_ = other.block_scatter_;
+            block_size_ = other.block_size_;
         }
 
         template <typename U, typename V>
@@ -162,6 +185,14 @@ class tensor_matrix
 
             iterator_[0] = MArray::viterator<>(len_m_, stride_m_);
             iterator_[1] = MArray::viterator<>(len_n_, stride_n_);
+            extra_len_ = 0;
+            extra_offsets_ = nullptr;
+            scatter_[0] = nullptr;
+            scatter_[1] = nullptr;
+            block_scatter_[0] = nullptr;
+            block_scatter_[1] = nullptr;
+            block_size_[0] = 0;
+            block_size_[1] = 0;
         }
 
         void transpose()
@@ -172,6 +203,9 @@ class tensor_matrix
             swap(leading_len_[0], leading_len_[1]);
             swap(leading_stride_[0], leading_stride_[1]);
             swap(iterator_[0], iterator_[1]);
+            swap(scatter_[0], scatter_[1]);
+            swap(block_scatter_[0], block_scatter_[1]);
+            swap(block_size_[0], block_size_[1]);
         }
 
         void swap(tensor_matrix& other)
@@ -183,6 +217,11 @@ class tensor_matrix
             swap(leading_len_, other.leading_len_);
             swap(leading_stride_, other.leading_stride_);
             swap(iterator_, other.iterator_);
+            swap(extra_len_, other.extra_len_);
+            swap(extra_offsets_, other.extra_offsets_);
+            swap(scatter_, other.scatter_);
+            swap(block_scatter_, other.block_scatter_);
+            swap(block_size_, other.block_size_);
         }
 
         friend void swap(tensor_matrix& a, tensor_matrix& b)
@@ -242,6 +281,56 @@ class tensor_matrix
             return ptr;
         }
 
+        /*
+         * Extra offsets correspond to tensor indices which appear in neither
+         * the row nor the column dimension (e.g. indices appearing only in
+         * this operand). When read, the matrix is summed over all extra
+         * offsets, and when written it is updated at each extra offset.
+         */
+        len_type extra_length() const
+        {
+            return extra_len_;
+        }
+
+        scatter_type extra_offsets() const
+        {
+            return extra_offsets_;
+        }
+
+        void extra_offsets(len_type len, scatter_type offsets)
+        {
+            extra_len_ = len;
+            extra_offsets_ = offsets;
+        }
+
+        /*
+         * Scatter and block scatter vectors may be computed once for the
+         * entire matrix and then shared by every block of it. They are only
+         * usable for blocks which start on a multiple of the same block size.
+         */
+        void block_scatter(unsigned dim, scatter_type scatter, len_type MB,
+                           scatter_type block_scatter)
+        {
+            TBLIS_ASSERT(dim < 2);
+            TBLIS_ASSERT(offset_[dim] == 0);
+            scatter_[dim] = scatter;
+            block_scatter_[dim] = block_scatter;
+            block_size_[dim] = MB;
+        }
+
+        bool block_scatter(unsigned dim, len_type MB, scatter_type& scatter,
+                           scatter_type& block_scatter) const
+        {
+            TBLIS_ASSERT(dim < 2);
+
+            if (!scatter_[dim] || block_size_[dim] != MB ||
+                offset_[dim]%MB != 0) return false;
+
+            scatter = scatter_[dim] + offset_[dim];
+            block_scatter = block_scatter_[dim] + offset_[dim]/MB;
+            return true;
+        }
+
         void fill_scatter(unsigned dim, stride_type* scatter)
         {
             TBLIS_ASSERT(dim < 2);
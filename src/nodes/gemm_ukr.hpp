@@ -2,6 +2,7 @@
 #define _TBLIS_NODES_GEMM_UKR_HPP_
 
 #include "util/basic_types.h"
+#include "util/macros.h"
 #include "util/thread.h"
 
 #include "configs/configs.hpp"
@@ -10,112 +11,136 @@ namespace tblis
 {
 
 template <typename T>
-void accum_utile(len_type m, len_type n,
+void accum_utile(const config& cfg, len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+                 T beta, bool conj_c, T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c,
+                 const tblis_epilogue* epilogue = nullptr)
 {
-    if (beta == T(0))
+    if (is_complex<T>::value && conj_c && beta != T(0))
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, p_c[i*rs_c + j*cs_c]);
             }
         }
     }
     else
+    {
+        cfg.update_nn_ukr.call<T>(m, n, p_ab, rs_ab, cs_ab, &beta, p_c, rs_c, cs_c);
+    }
+
+    if (epilogue)
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[i*rs_c + j*cs_c];
+                epilogue->func(epilogue->data, &p_c[i*rs_c + j*cs_c]);
             }
         }
     }
 }
 
 template <typename T>
-void accum_utile(len_type m, len_type n,
+void accum_utile(const config& cfg, len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
-                 const stride_type* TBLIS_RESTRICT rs_c, stride_type cs_c)
+                 T beta, bool conj_c, T* TBLIS_RESTRICT p_c,
+                 const stride_type* TBLIS_RESTRICT rs_c, stride_type cs_c,
+                 const tblis_epilogue* epilogue = nullptr)
 {
-    if (beta == T(0))
+    if (is_complex<T>::value && conj_c && beta != T(0))
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[rs_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, p_c[rs_c[i] + j*cs_c]);
             }
         }
     }
     else
+    {
+        cfg.update_sn_ukr.call<T>(m, n, p_ab, rs_ab, cs_ab, &beta, p_c, rs_c, cs_c);
+    }
+
+    if (epilogue)
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[rs_c[i] + j*cs_c];
+                epilogue->func(epilogue->data, &p_c[rs_c[i] + j*cs_c]);
             }
         }
     }
 }
 
 template <typename T>
-void accum_utile(len_type m, len_type n,
+void accum_utile(const config& cfg, len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
-                 stride_type rs_c, const stride_type* TBLIS_RESTRICT cs_c)
+                 T beta, bool conj_c, T* TBLIS_RESTRICT p_c,
+                 stride_type rs_c, const stride_type* TBLIS_RESTRICT cs_c,
+                 const tblis_epilogue* epilogue = nullptr)
 {
-    if (beta == T(0))
+    if (is_complex<T>::value && conj_c && beta != T(0))
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[i*rs_c + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, p_c[i*rs_c + cs_c[j]]);
             }
         }
     }
     else
+    {
+        cfg.update_ns_ukr.call<T>(m, n, p_ab, rs_ab, cs_ab, &beta, p_c, rs_c, cs_c);
+    }
+
+    if (epilogue)
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[i*rs_c + cs_c[j]];
+                epilogue->func(epilogue->data, &p_c[i*rs_c + cs_c[j]]);
             }
         }
     }
 }
 
 template <typename T>
-void accum_utile(len_type m, len_type n,
+void accum_utile(const config& cfg, len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
+                 T beta, bool conj_c, T* TBLIS_RESTRICT p_c,
                  const stride_type* TBLIS_RESTRICT rs_c,
-                 const stride_type* TBLIS_RESTRICT cs_c)
+                 const stride_type* TBLIS_RESTRICT cs_c,
+                 const tblis_epilogue* epilogue = nullptr)
 {
-    if (beta == T(0))
+    if (is_complex<T>::value && conj_c && beta != T(0))
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[rs_c[i] + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, p_c[rs_c[i] + cs_c[j]]);
             }
         }
     }
     else
+    {
+        cfg.update_ss_ukr.call<T>(m, n, p_ab, rs_ab, cs_ab, &beta, p_c, rs_c, cs_c);
+    }
+
+    if (epilogue)
     {
         for (len_type j = 0;j < n;j++)
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[rs_c[i] + cs_c[j]];
+                epilogue->func(epilogue->data, &p_c[rs_c[i] + cs_c[j]]);
             }
         }
     }
@@ -123,6 +148,9 @@ void accum_utile(len_type m, len_type n,
 
 struct gemm_micro_kernel
 {
+    bool conj_C = false;
+    const tblis_epilogue* epilogue = nullptr;
+
     template <typename T>
     void operator()(const communicator& comm, const config& cfg,
                     T alpha, matrix_view<T>& A,
@@ -147,7 +175,7 @@ struct gemm_micro_kernel
         stride_type rs_c = C.stride(0);
         stride_type cs_c = C.stride(1);
 
-        if (m == MR && n == NR)
+        if (!conj_C && !epilogue && m == MR && n == NR)
         {
             cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
                                  &beta, p_c, rs_c, cs_c);
@@ -160,8 +188,8 @@ struct gemm_micro_kernel
             cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
                                  &zero, &p_ab[0], rs_ab, cs_ab);
 
-            accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                        beta, p_c, rs_c, cs_c);
+            accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                        beta, conj_C, p_c, rs_c, cs_c, epilogue);
         }
     }
 
@@ -191,7 +219,7 @@ struct gemm_micro_kernel
         const stride_type* rscat_c = C.scatter(0);
         const stride_type* cscat_c = C.scatter(1);
 
-        if (m == MR && n == NR && rs_c != 0 && cs_c != 0)
+        if (!conj_C && !epilogue && m == MR && n == NR && rs_c != 0 && cs_c != 0)
         {
             cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
                                  &beta, p_c, rs_c, cs_c);
@@ -206,23 +234,23 @@ struct gemm_micro_kernel
 
             if (rs_c == 0 && cs_c == 0)
             {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cscat_c);
+                accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                            beta, conj_C, p_c, rscat_c, cscat_c, epilogue);
             }
             else if (rs_c == 0)
             {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cs_c);
+                accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                            beta, conj_C, p_c, rscat_c, cs_c, epilogue);
             }
             else if (cs_c == 0)
             {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cscat_c);
+                accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                            beta, conj_C, p_c, rs_c, cscat_c, epilogue);
             }
             else
             {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cs_c);
+                accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                            beta, conj_C, p_c, rs_c, cs_c, epilogue);
             }
         }
     }
@@ -256,7 +284,14 @@ struct gemm_micro_kernel
         const stride_type* rscat_c = C.scatter(0);
         const stride_type* cscat_c = C.scatter(1);
 
-        if (m == MR && n == NR && rs_c != 0 && cs_c != 0)
+        /*
+         * If there are extra offsets then the same result is accumulated
+         * into C at each of them.
+         */
+        len_type nextra = C.extra_length();
+        const stride_type* extra_c = C.extra_offsets();
+
+        if (!conj_C && !epilogue && nextra == 0 && m == MR && n == NR && rs_c != 0 && cs_c != 0)
         {
             cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
                                  &beta, p_c, rs_c, cs_c);
@@ -269,25 +304,30 @@ struct gemm_micro_kernel
             cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
                                  &zero, &p_ab[0], rs_ab, cs_ab);
 
-            if (rs_c == 0 && cs_c == 0)
-            {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cscat_c);
-            }
-            else if (rs_c == 0)
-            {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cs_c);
-            }
-            else if (cs_c == 0)
-            {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cscat_c);
-            }
-            else
+            for (len_type e = 0;e < std::max<len_type>(nextra, 1);e++)
             {
-                accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cs_c);
+                T* p_ce = p_c + (nextra ? extra_c[e] : 0);
+
+                if (rs_c == 0 && cs_c == 0)
+                {
+                    accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                                beta, conj_C, p_ce, rscat_c, cscat_c, epilogue);
+                }
+                else if (rs_c == 0)
+                {
+                    accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                                beta, conj_C, p_ce, rscat_c, cs_c, epilogue);
+                }
+                else if (cs_c == 0)
+                {
+                    accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                                beta, conj_C, p_ce, rs_c, cscat_c, epilogue);
+                }
+                else
+                {
+                    accum_utile(cfg, m, n, p_ab, rs_ab, cs_ab,
+                                beta, conj_C, p_ce, rs_c, cs_c, epilogue);
+                }
             }
         }
     }
@@ -5,6 +5,7 @@
 #include "util/thread.h"
 
 #include "matrix/tensor_matrix.hpp"
+#include "matrix/multi_tensor_matrix.hpp"
 
 #include "nodes/packm.hpp"
 
@@ -46,6 +47,137 @@ void block_scatter(const communicator& comm, MatrixA& A,
     comm.barrier();
 }
 
+/*
+ * Compute the scatter and block scatter vectors for all of A once, in
+ * parallel, so that every block of A visited by the matrify nodes can
+ * use them directly. The returned buffer must be kept alive (on the
+ * master thread) until all threads are done with A.
+ */
+template <typename T>
+MemoryPool::Block block_scatter(const communicator& comm, MemoryPool& pool,
+                                tensor_matrix<T>& A, len_type MB, len_type NB)
+{
+    len_type m = A.length(0);
+    len_type n = A.length(1);
+
+    MemoryPool::Block buffer;
+    stride_type* rscat = nullptr;
+
+    if (comm.master())
+    {
+        buffer = pool.allocate<stride_type>(2*m + 2*n);
+        rscat = buffer.get<stride_type>();
+    }
+
+    comm.broadcast(rscat);
+
+    stride_type* cscat = rscat+m;
+    stride_type* rbs = cscat+n;
+    stride_type* cbs = rbs+m;
+
+    block_scatter(comm, A, rscat, MB, rbs, cscat, NB, cbs);
+
+    A.block_scatter(0, rscat, MB, rbs);
+    A.block_scatter(1, cscat, NB, cbs);
+
+    return buffer;
+}
+
+/*
+ * Compute the scatter and block scatter vectors for each term. The buffers
+ * are returned in the same order as the terms.
+ */
+template <typename T>
+std::vector<MemoryPool::Block>
+block_scatter(const communicator& comm, MemoryPool& pool,
+              multi_tensor_matrix<T>& A, len_type MB, len_type NB)
+{
+    std::vector<MemoryPool::Block> buffers;
+
+    for (auto& t : A.terms())
+        buffers.push_back(block_scatter(comm, pool, t.matrix, MB, NB));
+
+    return buffers;
+}
+
+template <typename MatrixA>
+void get_block_scatter(MatrixA& A, unsigned dim, len_type MB,
+                       stride_type* scat_buf, stride_type* bs_buf,
+                       const stride_type*& scat, const stride_type*& bs)
+{
+    A.fill_block_scatter(dim, scat_buf, MB, bs_buf);
+    scat = scat_buf;
+    bs = bs_buf;
+}
+
+template <typename T>
+void get_block_scatter(tensor_matrix<T>& A, unsigned dim, len_type MB,
+                       stride_type* scat_buf, stride_type* bs_buf,
+                       const stride_type*& scat, const stride_type*& bs)
+{
+    if (A.block_scatter(dim, MB, scat, bs)) return;
+
+    A.fill_block_scatter(dim, scat_buf, MB, bs_buf);
+    scat = scat_buf;
+    bs = bs_buf;
+}
+
+template <typename T, typename MatrixA>
+block_scatter_matrix<T> matrify_block(MatrixA& A, len_type MB, len_type NB,
+                                      stride_type* rscat_buf, stride_type* rbs_buf,
+                                      stride_type* cscat_buf, stride_type* cbs_buf)
+{
+    const stride_type *rscat, *rbs, *cscat, *cbs;
+    get_block_scatter(A, 0, MB, rscat_buf, rbs_buf, rscat, rbs);
+    get_block_scatter(A, 1, NB, cscat_buf, cbs_buf, cscat, cbs);
+
+    block_scatter_matrix<T> M(A.length(0), A.length(1), A.data(),
+                              rscat, MB, rbs,
+                              cscat, NB, cbs);
+    M.extra_offsets(A.extra_length(), A.extra_offsets());
+
+    return M;
+}
+
+/*
+ * Each segment gets its own part of the scatter buffers along the cat
+ * dimension. Along the other dimension the segments are different but the
+ * blocks are always aligned, so the terms must have precomputed scatter
+ * vectors (see block_scatter above).
+ */
+template <typename T>
+multi_block_scatter_matrix<T> matrify_block(multi_tensor_matrix<T>& A, len_type MB, len_type NB,
+                                            stride_type* rscat_buf, stride_type* rbs_buf,
+                                            stride_type* cscat_buf, stride_type* cbs_buf)
+{
+    unsigned d = A.cat_dim();
+    len_type MBs[2] = {MB, NB};
+    stride_type* scat_buf[2] = {rscat_buf, cscat_buf};
+    stride_type* bs_buf[2] = {rbs_buf, cbs_buf};
+
+    multi_block_scatter_matrix<T> M(A.length(0), A.length(1), d);
+
+    A.for_each_segment(
+    [&](tensor_matrix<T>& segment, len_type off, T alpha, bool conj)
+    {
+        const stride_type *scat[2], *bs[2];
+
+        if (!segment.block_scatter(!d, MBs[!d], scat[!d], bs[!d]))
+            tblis_abort_with_message("", "Scatter vectors must be precomputed");
+
+        get_block_scatter(segment, d, MBs[d], scat_buf[d]+off, bs_buf[d]+off,
+                          scat[d], bs[d]);
+
+        M.push_back(off, block_scatter_matrix<T>(segment.length(0), segment.length(1),
+                                                 segment.data(),
+                                                 scat[0], MB, bs[0],
+                                                 scat[1], NB, bs[1]),
+                    alpha, conj);
+    });
+
+    return M;
+}
+
 template <int Mat> struct matrify_and_run;
 
 template <> struct matrify_and_run<matrix_constants::MAT_A>
@@ -57,15 +189,8 @@ template <> struct matrify_and_run<matrix_constants::MAT_A>
         const len_type MB = cfg.gemm_mr.def<T>();
         const len_type NB = cfg.gemm_kr.def<T>();
 
-        //block_scatter(comm, A, parent.rscat, MB, parent.rbs,
-        //                       parent.cscat, NB, parent.cbs);
-
-        A.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
-        A.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
-
-        block_scatter_matrix<T> M(A.length(0), A.length(1), A.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        auto M = matrify_block<T>(A, MB, NB, parent.rscat, parent.rbs,
+                                  parent.cscat, parent.cbs);
 
         parent.child(comm, cfg, alpha, M, B, beta, C);
     }
@@ -80,15 +205,8 @@ template <> struct matrify_and_run<matrix_constants::MAT_B>
         const len_type MB = cfg.gemm_kr.def<T>();
         const len_type NB = cfg.gemm_nr.def<T>();
 
-        //block_scatter(comm, B, parent.rscat, MB, parent.rbs,
-        //                       parent.cscat, NB, parent.cbs);
-
-        B.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
-        B.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
-
-        block_scatter_matrix<T> M(B.length(0), B.length(1), B.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        auto M = matrify_block<T>(B, MB, NB, parent.rscat, parent.rbs,
+                                  parent.cscat, parent.cbs);
 
         parent.child(comm, cfg, alpha, A, M, beta, C);
     }
@@ -103,15 +221,8 @@ template <> struct matrify_and_run<matrix_constants::MAT_C>
         const len_type MB = cfg.gemm_mr.def<T>();
         const len_type NB = cfg.gemm_nr.def<T>();
 
-        //block_scatter(comm, C, parent.rscat, MB, parent.rbs,
-        //                       parent.cscat, NB, parent.cbs);
-
-        C.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
-        C.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
-
-        block_scatter_matrix<T> M(C.length(0), C.length(1), C.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        auto M = matrify_block<T>(C, MB, NB, parent.rscat, parent.rbs,
+                                  parent.cscat, parent.cbs);
 
         parent.child(comm, cfg, alpha, A, B, beta, M);
     }
@@ -191,21 +302,36 @@ struct matrify_and_pack : matrify<Mat, Pool, pack<Mat, Pool, Child>>
         m = round_up(m, MR);
         n = round_up(n, NR);
 
+        /*
+         * Packed micro-panels may be padded out to the register blocksize
+         * extent.
+         */
+        len_type m_p = (Mat == MAT_A ? (m/MR)*cfg.gemm_mr.extent<T>() : m);
+        len_type n_p = (Mat == MAT_B ? (n/NR)*cfg.gemm_nr.extent<T>() : n);
+
         auto& pack_buffer = child.pack_buffer;
         auto& pack_ptr = child.pack_ptr;
 
+        /*
+         * The scatter vectors go after the packing buffer(s). They are only
+         * used while packing, so they need not be double-buffered.
+         */
         if (!pack_ptr)
         {
+            child.double_buffer = use_double_buffer(comm);
+            child.pack_size = pack_buffer_size<T>(m_p, n_p);
+            len_type pack_size = (child.double_buffer ? 2 : 1)*child.pack_size;
+
             if (comm.master())
             {
                 len_type scatter_size = size_as_type<stride_type,T>(2*m + 2*n);
-                pack_buffer = Pool.allocate<T>(m*n + std::max(m,n)*TBLIS_MAX_UNROLL + scatter_size);
+                pack_buffer = Pool.allocate<T>(pack_size + scatter_size);
                 pack_ptr = pack_buffer.get();
             }
 
             comm.broadcast(pack_ptr);
 
-            rscat = convert_and_align<T,stride_type>(static_cast<T*>(pack_ptr) + m*n);
+            rscat = convert_and_align<T,stride_type>(static_cast<T*>(pack_ptr) + pack_size);
             cscat = rscat+m;
             rbs = cscat+n;
             cbs = rbs+m;
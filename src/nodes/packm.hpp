@@ -3,12 +3,14 @@
 
 #include "util/thread.h"
 #include "util/basic_types.h"
+#include "util/env.hpp"
 
 #include "memory/alignment.hpp"
 #include "memory/memory_pool.hpp"
 
 #include "matrix/scatter_matrix.hpp"
 #include "matrix/block_scatter_matrix.hpp"
+#include "matrix/multi_tensor_matrix.hpp"
 
 #include "configs/configs.hpp"
 
@@ -24,7 +26,89 @@ struct pack_row_panel
 {
     static constexpr bool Trans = Mat == matrix_constants::MAT_B;
 
-    void operator()(const communicator& comm, const config& cfg,
+    /*
+     * Conjugate a freshly-packed micro-panel in place (it is still in cache).
+     */
+    static void conj_panel(len_type m, len_type k, len_type ME, T* p_ap)
+    {
+        for (len_type p = 0;p < k;p++)
+        {
+            for (len_type mr = 0;mr < m;mr++)
+            {
+                p_ap[mr + ME*p] = conj(p_ap[mr + ME*p]);
+            }
+        }
+    }
+
+    /*
+     * Convert a freshly-packed complex micro-panel to the format used by the
+     * 1m method (see gemm_ukr_1m). If expand is true, then the second half
+     * of each column is filled in with i times the first half (the 1e
+     * format), otherwise the real and imaginary parts of each column are
+     * separated (the 1r format).
+     */
+    static void pack_1m_panel(bool expand, len_type MR, len_type ME,
+                              len_type k, T* p_ap)
+    {
+        typedef real_type_t<T> U;
+
+        constexpr len_type MR_MAX = 64;
+        TBLIS_ASSERT(MR <= MR_MAX);
+        TBLIS_ASSERT(ME == (expand ? 2*MR : MR));
+
+        U* p_ar = reinterpret_cast<U*>(p_ap);
+
+        for (len_type p = 0;p < k;p++)
+        {
+            U* col = p_ar + 2*ME*p;
+
+            if (expand)
+            {
+                for (len_type mr = 0;mr < MR;mr++)
+                {
+                    col[2*(MR+mr)  ] = -col[2*mr+1];
+                    col[2*(MR+mr)+1] =  col[2*mr  ];
+                }
+            }
+            else
+            {
+                U imag[MR_MAX];
+
+                for (len_type mr = 0;mr < MR;mr++)
+                {
+                    imag[mr] = col[2*mr+1];
+                    col[mr] = col[2*mr];
+                }
+
+                for (len_type mr = 0;mr < MR;mr++)
+                {
+                    col[MR+mr] = imag[mr];
+                }
+            }
+        }
+    }
+
+    static void finish_panel(const config& cfg, bool conj_A, T alpha,
+                             len_type m, len_type k, len_type MR, len_type ME,
+                             T* p_ap)
+    {
+        if (is_complex<T>::value && conj_A) conj_panel(m, k, ME, p_ap);
+        if (alpha != T(1)) scale_panel(m, k, ME, alpha, p_ap);
+
+        /*
+         * The 1e panel is the one whose extent is twice its register
+         * blocksize. This is fixed by the 1m kernel at compile time, and
+         * must agree with the (runtime) gemm layout.
+         */
+        if (is_complex<T>::value && cfg.gemm_1m.value<T>())
+        {
+            const bool expand = (ME == 2*MR);
+            TBLIS_ASSERT(expand == (Trans == cfg.gemm_row_major.value<T>()));
+            pack_1m_panel(expand, MR, ME, k, p_ap);
+        }
+    }
+
+    void operator()(const communicator& comm, const config& cfg, bool conj_A,
                     matrix_view<T>& A, matrix_view<T>& Ap) const
     {
         const len_type MR = (!Trans ? cfg.gemm_mr.def<T>()
@@ -58,12 +142,14 @@ struct pack_row_panel
             else
                 cfg.pack_nn_nr_ukr.call<T>(m, k, p_a, rs_a, cs_a, p_ap);
 
+            finish_panel(cfg, conj_A, T(1), m, k, MR, ME, p_ap);
+
             p_a += m*rs_a;
             p_ap += ME*k_a;
         }
     }
 
-    void operator()(const communicator& comm, const config& cfg,
+    void operator()(const communicator& comm, const config& cfg, bool conj_A,
                     const_scatter_matrix_view<T>& A, matrix_view<T>& Ap) const
     {
         const len_type MR = (!Trans ? cfg.gemm_mr.def<T>()
@@ -89,7 +175,7 @@ struct pack_row_panel
         p_a += m_first*rs_a + k_first*cs_a;
         rscat_a += m_first;
         cscat_a += k_first;
-        p_ap += m_first*k_a + k_first*ME;
+        p_ap += (m_first/MR)*ME*k_a + k_first*ME;
 
         for (len_type off_m = m_first;off_m < m_last;off_m += MR)
         {
@@ -133,12 +219,62 @@ struct pack_row_panel
                 p_a += m*rs_a;
             }
 
+            finish_panel(cfg, conj_A, T(1), m, k, MR, ME, p_ap);
+
             p_ap += ME*k_a;
         }
     }
 
-    void operator()(const communicator& comm, const config& cfg,
+    /*
+     * Scale a freshly-packed micro-panel in place.
+     */
+    static void scale_panel(len_type m, len_type k, len_type ME, T alpha, T* p_ap)
+    {
+        for (len_type p = 0;p < k;p++)
+        {
+            for (len_type mr = 0;mr < m;mr++)
+            {
+                p_ap[mr + ME*p] *= alpha;
+            }
+        }
+    }
+
+    void operator()(const communicator& comm, const config& cfg, bool conj_A,
                     block_scatter_matrix<T> A, matrix_view<T>& Ap) const
+    {
+        pack_block_scatter(comm, cfg, conj_A, T(1), A, Ap.data(),
+                           A.length(!Trans));
+    }
+
+    /*
+     * Each segment is packed into its own range of the packed panels, so
+     * that the result is the same as if the terms were a single matrix.
+     */
+    void operator()(const communicator& comm, const config& cfg, bool conj_A,
+                    const multi_block_scatter_matrix<T>& A, matrix_view<T>& Ap) const
+    {
+        TBLIS_ASSERT(A.cat_dim() == !Trans);
+
+        const len_type ME = (!Trans ? cfg.gemm_mr.extent<T>()
+                                    : cfg.gemm_nr.extent<T>());
+
+        for (auto& segment : A.segments())
+        {
+            pack_block_scatter(comm, cfg, conj_A != segment.conj,
+                               segment.alpha, segment.matrix,
+                               Ap.data() + segment.offset*ME,
+                               A.length(!Trans));
+        }
+    }
+
+    /*
+     * Pack A into the micro-panels starting at p_ap, where each micro-panel
+     * holds k_p columns (k_p may be larger than the length of A if A is only
+     * part of the packed matrix).
+     */
+    void pack_block_scatter(const communicator& comm, const config& cfg,
+                            bool conj_A, T alpha, block_scatter_matrix<T> A,
+                            T* p_ap, len_type k_p) const
     {
         const len_type MR = (!Trans ? cfg.gemm_mr.def<T>()
                                     : cfg.gemm_nr.def<T>());
@@ -151,14 +287,13 @@ struct pack_row_panel
 
         len_type m_a = A.length( Trans);
         len_type k_a = A.length(!Trans);
-        T* p_ap = Ap.data();
 
         len_type m_first, m_last, k_first, k_last;
         std::tie(m_first, m_last, std::ignore,
                  k_first, k_last, std::ignore) =
             comm.distribute_over_threads_2d(m_a, k_a, MR, KR);
 
-        p_ap += m_first*k_a + k_first*ME;
+        p_ap += (m_first/MR)*ME*k_p + k_first*ME;
 
         len_type off_m = m_first;
 
@@ -169,6 +304,15 @@ struct pack_row_panel
         const stride_type* cscat_a = A.scatter(!Trans) + k_first;
         const stride_type* cbs_a = A.block_scatter(!Trans) + k_first/KR;
 
+        /*
+         * If there are extra offsets then the packed panel is the sum over
+         * all of them: the first is packed as usual and the rest are
+         * accumulated into the packed panel.
+         */
+        len_type nextra = A.extra_length();
+        const stride_type* extra_a = A.extra_offsets();
+        const T* p_a0 = p_a + (nextra ? extra_a[0] : 0);
+
         while (off_m < m_last)
         {
             stride_type rs_a = A.stride(Trans);
@@ -180,19 +324,34 @@ struct pack_row_panel
             if (rs_a == 0)
             {
                 if (!Trans)
-                    cfg.pack_sb_mr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
+                    cfg.pack_sb_mr_ukr.call<T>(m, k, p_a0, rscat_a, cscat_a, cbs_a, p_ap);
                 else
-                    cfg.pack_sb_nr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
+                    cfg.pack_sb_nr_ukr.call<T>(m, k, p_a0, rscat_a, cscat_a, cbs_a, p_ap);
             }
             else
             {
                 if (!Trans)
-                    cfg.pack_nb_mr_ukr.call<T>(m, k, p_a+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
+                    cfg.pack_nb_mr_ukr.call<T>(m, k, p_a0+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
                 else
-                    cfg.pack_nb_nr_ukr.call<T>(m, k, p_a+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
+                    cfg.pack_nb_nr_ukr.call<T>(m, k, p_a0+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
             }
 
-            p_ap += ME*k_a;
+            for (len_type e = 1;e < nextra;e++)
+            {
+                const T* p_ae = p_a + extra_a[e];
+
+                for (len_type p = 0;p < k;p++)
+                {
+                    for (len_type mr = 0;mr < m;mr++)
+                    {
+                        p_ap[mr + ME*p] += p_ae[rscat_a[mr] + cscat_a[p]];
+                    }
+                }
+            }
+
+            finish_panel(cfg, conj_A, alpha, m, k, MR, ME, p_ap);
+
+            p_ap += ME*k_p;
             A.shift_block(Trans, 1);
             off_m += MR;
         }
@@ -202,19 +361,26 @@ struct pack_row_panel
     }
 };
 
+/*
+ * Pack a panel and then run the child on it. The barrier after packing makes
+ * sure that the whole panel is ready. If sync is true, then there is also a
+ * barrier after the child so that the panel may be overwritten immediately;
+ * otherwise (with double-buffering) the barrier after the next panel is
+ * packed serves the same purpose.
+ */
 template <typename Pack, int Mat> struct pack_and_run;
 
 template <typename Pack>
 struct pack_and_run<Pack, matrix_constants::MAT_A>
 {
     template <typename Run, typename T, typename MatrixA, typename MatrixB, typename MatrixC, typename MatrixP>
-    pack_and_run(Run& run, const communicator& comm, const config& cfg,
+    pack_and_run(Run& run, const communicator& comm, const config& cfg, bool conj, bool sync,
                  T alpha, MatrixA& A, MatrixB& B, T beta, MatrixC& C, MatrixP& P)
     {
-        Pack()(comm, cfg, A, P);
+        Pack()(comm, cfg, conj, A, P);
         comm.barrier();
         run(comm, cfg, alpha, P, B, beta, C);
-        comm.barrier();
+        if (sync) comm.barrier();
     }
 };
 
@@ -222,22 +388,56 @@ template <typename Pack>
 struct pack_and_run<Pack, matrix_constants::MAT_B>
 {
     template <typename Run, typename T, typename MatrixA, typename MatrixB, typename MatrixC, typename MatrixP>
-    pack_and_run(Run& run, const communicator& comm, const config& cfg,
+    pack_and_run(Run& run, const communicator& comm, const config& cfg, bool conj, bool sync,
                  T alpha, MatrixA& A, MatrixB& B, T beta, MatrixC& C, MatrixP& P)
     {
-        Pack()(comm, cfg, B, P);
+        Pack()(comm, cfg, conj, B, P);
         comm.barrier();
         run(comm, cfg, alpha, A, P, beta, C);
-        comm.barrier();
+        if (sync) comm.barrier();
     }
 };
 
+/*
+ * Whether to double-buffer the packed panels. This is only useful with more
+ * than one thread, and may be turned off (to halve the packing memory) with
+ * TBLIS_PACK_DOUBLE_BUFFER=0.
+ */
+inline bool use_double_buffer(const communicator& comm)
+{
+    static const bool enabled = envtol("TBLIS_PACK_DOUBLE_BUFFER", 1) != 0;
+    return enabled && comm.num_threads() > 1;
+}
+
+/*
+ * Size of each of the packing buffers, rounded up so that the second buffer
+ * has the same (page) alignment as the first.
+ */
+template <typename T>
+len_type pack_buffer_size(len_type m_p, len_type k_p)
+{
+    return round_up(m_p*k_p+std::max(m_p,k_p)*TBLIS_MAX_UNROLL,
+                    4096/static_cast<len_type>(sizeof(T)));
+}
+
+/*
+ * With double-buffering, consecutive panels are packed into alternating
+ * buffers. Threads may then start packing the next panel while others are
+ * still computing with the current one, and only one barrier per panel is
+ * needed. The enclosing partition along k must end with a barrier (see
+ * partition) so that all threads are done with both buffers when the tree
+ * returns.
+ */
 template <int Mat, MemoryPool& Pool, typename Child>
 struct pack
 {
     Child child;
     MemoryPool::Block pack_buffer;
     void* pack_ptr = nullptr;
+    len_type pack_size = 0;
+    bool double_buffer = false;
+    int cur_buffer = 0;
+    bool conj = false;
 
     template <typename T, typename MatrixA, typename MatrixB, typename MatrixC>
     void operator()(const communicator& comm, const config& cfg,
@@ -256,23 +456,37 @@ struct pack
 
         if (!pack_ptr)
         {
+            double_buffer = use_double_buffer(comm);
+            pack_size = pack_buffer_size<T>(m_p, k_p);
+
             if (comm.master())
             {
-                pack_buffer = Pool.allocate<T>(m_p*k_p+std::max(m_p,k_p)*TBLIS_MAX_UNROLL);
+                pack_buffer = Pool.allocate<T>((double_buffer ? 2 : 1)*pack_size);
                 pack_ptr = pack_buffer.get();
             }
 
             comm.broadcast(pack_ptr);
         }
 
+        /*
+         * Each micro-panel of MR rows (or columns) takes up ME*k_p elements,
+         * so that moving MR rows (or columns) ahead in P moves to the next
+         * micro-panel.
+         */
+        TBLIS_ASSERT(ME%MR == 0);
+        stride_type s_p = (ME/MR)*k_p;
+
         matrix_view<T> P({!Trans ? m_p : k_p,
                           !Trans ? k_p : m_p},
-                         static_cast<T*>(pack_ptr),
-                         {!Trans? k_p :   1,
-                          !Trans?   1 : k_p});
+                         static_cast<T*>(pack_ptr) + cur_buffer*pack_size,
+                         {!Trans? s_p :   1,
+                          !Trans?   1 : s_p});
 
         typedef pack_row_panel<T, Mat> Pack;
-        pack_and_run<Pack, Mat>(child, comm, cfg, alpha, A, B, beta, C, P);
+        pack_and_run<Pack, Mat>(child, comm, cfg, conj, !double_buffer,
+                                alpha, A, B, beta, C, P);
+
+        if (double_buffer) cur_buffer = !cur_buffer;
     }
 };
 
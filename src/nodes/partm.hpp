@@ -1,14 +1,46 @@
 #ifndef _TBLIS_NODES_PARTM_HPP_
 #define _TBLIS_NODES_PARTM_HPP_
 
+#include <atomic>
+
 #include "util/basic_types.h"
 #include "util/thread.h"
+#include "util/gemm_thread.hpp"
+#include "util/env.hpp"
 
 #include "configs/configs.hpp"
 
 namespace tblis
 {
 
+/*
+ * Whether cache-block partitions that are split over several gangs should
+ * hand out blocks dynamically for all configurations. Set
+ * TBLIS_DYNAMIC_PARTITION=1 to enable.
+ */
+inline bool use_dynamic_partition()
+{
+    static const bool enabled = envtol("TBLIS_DYNAMIC_PARTITION", 0) != 0;
+    return enabled;
+}
+
+/*
+ * Partition one dimension of the product into blocks of the given blocksize.
+ *
+ * Normally, the range is divided up statically between the gangs and each
+ * gang loops over the blocks in its own part. In dynamic mode, the gangs
+ * instead claim one block at a time from a shared counter, so that a gang
+ * which runs slowly (because of SMT or NUMA interference, or because it is
+ * on a slower core) simply ends up with fewer blocks. Only the gang master
+ * claims blocks, and the claim is passed to the rest of the gang through
+ * one of two alternating slots, which needs a single barrier per block.
+ *
+ * Dynamic mode is only used along m and n, and only for cache blocksizes
+ * (the overhead is too large for register blocks). It may be forced on or
+ * off by setting dynamic before the first call, otherwise it is used if
+ * the dynamic_partition parameter of the configuration or
+ * use_dynamic_partition says so.
+ */
 template <int Dim, blocksize config::*BS, typename Child>
 struct partition
 {
@@ -16,6 +48,12 @@ struct partition
     communicator subcomm;
     bool ganged = false;
     int distribute = 1;
+    int dynamic = -1;
+    std::atomic<len_type> next_block{0};
+    std::atomic<len_type>* shared_next = nullptr;
+    len_type claim_slot[2] = {};
+    len_type* shared_claim = nullptr;
+    int cur_slot = 0;
 
     template <typename T, typename MatrixA, typename MatrixB, typename MatrixC>
     void operator()(const communicator& comm, const config& cfg,
@@ -27,11 +65,8 @@ struct partition
         const len_type M_def  = M.def<T>();
         const len_type M_max  = M.max<T>(); // Equal to M_def for register block sizes
         const len_type M_iota = M.iota<T>(); // Equal to the corresponding register block size
-        const len_type M_ext  = M.extent<T>(); // Equal to M_def for cache block sizes
         const len_type M_over = M_max-M_def;
 
-        TBLIS_ASSERT(M_ext == M_def);
-
         //printf("partition along: %c\n", "MNK"[Dim]);
         //printf("A before: %p %ld %ld %ld %ld\n", A.data(), A.length(0), A.length(1), A.stride(0), A.stride(1));
         //printf("B before: %p %ld %ld %ld %ld\n", B.data(), B.length(0), B.length(1), B.stride(0), B.stride(1));
@@ -57,6 +92,70 @@ struct partition
             //printf("distributing %d ways\n", distribute);
             subcomm = comm.gang(TCI_EVENLY, distribute);
             ganged = true;
+
+            if (dynamic < 0)
+                dynamic = (cfg.dynamic_partition.value<T>() ||
+                           use_dynamic_partition()) && Dim != DIM_K &&
+                          M_def != M_iota && subcomm.num_gangs() > 1;
+
+            if (dynamic)
+            {
+                shared_next = &next_block;
+                comm.broadcast(shared_next);
+                shared_claim = claim_slot;
+                subcomm.broadcast(shared_claim);
+            }
+        }
+
+        if (dynamic)
+        {
+            /*
+             * All threads must be done claiming blocks from the last call
+             * before the counter is reset.
+             */
+            comm.barrier();
+            if (comm.master()) shared_next->store(0, std::memory_order_relaxed);
+            comm.barrier();
+
+            /*
+             * As in the static case, the first block takes the remainder if
+             * it is small enough. Each gang starts with a fixed block, so that
+             * the first block a gang sees (which sets the size of the packing
+             * buffers below) is never smaller than the later ones.
+             */
+            len_type m_tot = std::min(m_u, m_v);
+            len_type n_block = m_tot/M_def;
+            len_type m_extra = 0;
+
+            if (m_tot%M_def > M_over || n_block == 0)
+            {
+                if (m_tot > 0) n_block++;
+            }
+            else
+            {
+                m_extra = m_tot%M_def;
+            }
+
+            for (len_type block = subcomm.gang_num();block < n_block;)
+            {
+                len_type m_off = (block == 0 ? 0 : block*M_def+m_extra);
+                len_type m_loc = std::min(m_tot-m_off, block == 0 ? M_def+m_extra : M_def);
+
+                shift(m_off, m_off);
+                length(m_loc, m_loc);
+                child(subcomm, cfg, alpha, A, B, beta, C);
+                shift(-m_off, -m_off);
+
+                if (subcomm.master())
+                    shared_claim[cur_slot] = subcomm.num_gangs() +
+                        shared_next->fetch_add(1, std::memory_order_relaxed);
+                subcomm.barrier();
+                block = shared_claim[cur_slot];
+                cur_slot = !cur_slot;
+            }
+
+            length(m_u, m_v);
+            return;
         }
 
         len_type m_first, m_last;
@@ -74,6 +173,14 @@ struct partition
 
         len_type M_cur = (m_len%M_def <= M_over ? M_max : M_def);
 
+        /*
+         * Only the first block along k sees the original C, so only it
+         * scales (and possibly conjugates) C. Likewise, only the last block
+         * produces the final value of C, so only it applies the epilogue.
+         */
+        bool conj_C = leaf(child).conj_C;
+        auto epilogue = leaf(child).epilogue;
+
         while (m_off < m_last)
         {
             len_type m_loc = std::min(m_last-m_off, M_cur);
@@ -81,8 +188,15 @@ struct partition
 
             //printf("[%ld:%ld)\n", m_off, m_off+m_loc);
 
+            if (Dim == DIM_K)
+                leaf(child).epilogue = (m_off+m_loc < m_last ? nullptr : epilogue);
+
             child(subcomm, cfg, alpha, A, B, beta, C);
-            if (Dim == DIM_K) beta = 1.0;
+            if (Dim == DIM_K)
+            {
+                beta = 1.0;
+                leaf(child).conj_C = false;
+            }
 
             shift(M_cur, M_cur);
             m_off += M_cur;
@@ -92,6 +206,18 @@ struct partition
         shift(-m_off, -m_off);
         length(m_u, m_v);
 
+        if (Dim == DIM_K)
+        {
+            leaf(child).conj_C = conj_C;
+            leaf(child).epilogue = epilogue;
+
+            /*
+             * Double-buffered packing nodes below don't wait for all threads
+             * to finish with a panel, so do that here.
+             */
+            subcomm.barrier();
+        }
+
         //printf("A after: %p %ld %ld %ld %ld\n", A.data(), A.length(0), A.length(1), A.stride(0), A.stride(1));
         //printf("B after: %p %ld %ld %ld %ld\n", B.data(), B.length(0), B.length(1), B.stride(0), B.stride(1));
         //printf("C after: %p %ld %ld %ld %ld\n", C.data(), C.length(0), C.length(1), C.stride(0), C.stride(1));
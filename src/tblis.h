@@ -22,5 +22,8 @@
 #include "iface/3m/mult.h"
 
 #include "iface/3t/mult.h"
+#include "iface/3t/network.h"
+
+#include "iface/config.h"
 
 #endif
@@ -86,15 +86,16 @@ void contract_blis(const communicator& comm, const config& cfg,
                    const std::vector<len_type>& len_AB,
                    const std::vector<len_type>& len_AC,
                    const std::vector<len_type>& len_BC,
-                   T alpha, const T* A,
+                   T alpha, bool conj_A, const T* A,
                    const std::vector<stride_type>& stride_A_AB,
                    const std::vector<stride_type>& stride_A_AC,
-                            const T* B,
+                            bool conj_B, const T* B,
                    const std::vector<stride_type>& stride_B_AB,
                    const std::vector<stride_type>& stride_B_BC,
-                   T  beta,       T* C,
+                   T  beta, bool conj_C,       T* C,
                    const std::vector<stride_type>& stride_C_AC,
-                   const std::vector<stride_type>& stride_C_BC);
+                   const std::vector<stride_type>& stride_C_BC,
+                   const tblis_epilogue* epilogue = nullptr);
 
 extern MemoryPool BuffersForA, BuffersForB, BuffersForScatter;
 extern MemoryPool BuffersForScatter;
@@ -809,13 +810,13 @@ int contract_batch(T alpha, const_batched_tensor_view<T> A, const label_type* id
 
                                 internal::contract_blis(subcomm, get_default_config(),
                                       dense_len_AB, dense_len_AC, dense_len_BC,
-                                                 alpha, batch_A[m][k],
+                                                 alpha, false, batch_A[m][k],
                                                         dense_stride_A_AB,
                                                         dense_stride_A_AC,
-                                                        batch_B[k][n],
+                                                        false, batch_B[k][n],
                                                         dense_stride_B_AB,
                                                         dense_stride_B_BC,
-                                      batch_beta[m][n], batch_C[m][n],
+                                      batch_beta[m][n], false, batch_C[m][n],
                                                         dense_stride_C_AC,
                                                         dense_stride_C_BC);
 
@@ -850,13 +851,13 @@ int contract_batch(T alpha, const_batched_tensor_view<T> A, const label_type* id
 
                                 internal::contract_blis(subcomm, get_default_config(),
                                       dense_len_AB, dense_len_AC, dense_len_BC,
-                                                 alpha, batch_A[m][k],
+                                                 alpha, false, batch_A[m][k],
                                                         dense_stride_A_AB,
                                                         dense_stride_A_AC,
-                                                        batch_B[k][n],
+                                                        false, batch_B[k][n],
                                                         dense_stride_B_AB,
                                                         dense_stride_B_BC,
-                                      batch_beta[m][n], batch_C[m][n],
+                                      batch_beta[m][n], false, batch_C[m][n],
                                                         dense_stride_C_AC,
                                                         dense_stride_C_BC);
 
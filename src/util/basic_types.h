@@ -60,6 +60,15 @@ typedef enum
     TYPE_DCOMPLEX = 3
 } type_t;
 
+typedef enum
+{
+    BLIS_BASED   = 0,
+    BLAS_BASED   = 1,
+    REFERENCE    = 2,
+    AUTOMATIC    = 3,
+    SMALL_TENSOR = 4
+} impl_t;
+
 typedef TBLIS_LEN_TYPE len_type;
 typedef TBLIS_STRIDE_TYPE stride_type;
 typedef TBLIS_LABEL_TYPE label_type;
@@ -536,6 +545,18 @@ typedef struct tblis_tensor
 
 } tblis_tensor;
 
+/*
+ * An elementwise operation applied to each element of the output of a
+ * contraction as soon as its final value has been computed (while it is
+ * still in cache): func(data, c) is called with a pointer c to the element,
+ * which has the same type as the output.
+ */
+typedef struct tblis_epilogue
+{
+    void (*func)(void* data, void* c);
+    void* data;
+} tblis_epilogue;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -16,6 +16,8 @@ enum {FEATURE_MASK_SSE3     = (1u<< 0), //CPUID[EAX=1]:ECX[0]
       FEATURE_MASK_AVX512F  = (1u<<16), //CPUID[EAX=7,ECX=0]:EBX[16]
       FEATURE_MASK_AVX512PF = (1u<<26), //CPUID[EAX=7,ECX=0]:EBX[26]
       FEATURE_MASK_AVX512DQ = (1u<<17), //CPUID[EAX=7,ECX=0]:EBX[17]
+      FEATURE_MASK_AVX512BW = (1u<<30), //CPUID[EAX=7,ECX=0]:EBX[30]
+      FEATURE_MASK_AVX512VL = (1u<<31), //CPUID[EAX=7,ECX=0]:EBX[31]
       FEATURE_MASK_XGETBV   = (1u<<26)|
                               (1u<<27), //CPUID[EAX=1]:ECX[27:26]
       XGETBV_MASK_XMM       = 0x02u,     //XCR0[1]
@@ -75,6 +77,8 @@ int get_cpu_type(int& family, int& model, int& features)
         if (check_features(ebx, FEATURE_MASK_AVX512F)) features |= FEATURE_AVX512F;
         if (check_features(ebx, FEATURE_MASK_AVX512PF)) features |= FEATURE_AVX512PF;
         if (check_features(ebx, FEATURE_MASK_AVX512DQ)) features |= FEATURE_AVX512DQ;
+        if (check_features(ebx, FEATURE_MASK_AVX512BW)) features |= FEATURE_AVX512BW;
+        if (check_features(ebx, FEATURE_MASK_AVX512VL)) features |= FEATURE_AVX512VL;
     }
 
     if (cpuid_max_ext >= 0x80000001u)
@@ -145,7 +149,9 @@ int get_cpu_type(int& family, int& model, int& features)
         {
             features &= ~(FEATURE_AVX512F|
                           FEATURE_AVX512PF|
-                          FEATURE_AVX512DQ);
+                          FEATURE_AVX512DQ|
+                          FEATURE_AVX512BW|
+                          FEATURE_AVX512VL);
         }
 
         if (!check_features(eax, XGETBV_MASK_XMM|
@@ -182,6 +188,8 @@ int get_cpu_type(int& family, int& model, int& features)
     //fprintf(stderr, "avx512f: %d\n", check_features(features, FEATURE_AVX512F));
     //fprintf(stderr, "avx512pf: %d\n", check_features(features, FEATURE_AVX512PF));
     //fprintf(stderr, "avx512dq: %d\n", check_features(features, FEATURE_AVX512DQ));
+    //fprintf(stderr, "avx512bw: %d\n", check_features(features, FEATURE_AVX512BW));
+    //fprintf(stderr, "avx512vl: %d\n", check_features(features, FEATURE_AVX512VL));
 
     if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "AuthenticAMD") == 0)
         return VENDOR_AMD;
@@ -191,6 +199,150 @@ int get_cpu_type(int& family, int& model, int& features)
         return VENDOR_UNKNOWN;
 }
 
+int get_avx512_fma_units()
+{
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+
+    if (vendor != VENDOR_INTEL ||
+        !check_features(features, FEATURE_AVX512F)) return 0;
+
+    /*
+     * KNL and KNM have two units.
+     */
+    if (check_features(features, FEATURE_AVX512PF)) return 2;
+
+    /*
+     * Server parts after Skylake-SP/Cascade Lake (Ice Lake-SP, Sapphire
+     * Rapids, Emerald Rapids) have two units. Client parts (Cannon Lake, Ice
+     * Lake, Tiger Lake, Rocket Lake) have one.
+     */
+    if (model == 0x6A || model == 0x6C || model == 0x8F || model == 0xCF) return 2;
+    if (model != 0x55) return 1;
+
+    /*
+     * Skylake-SP and Cascade Lake share a model number, and the number of
+     * units depends on the SKU, which can only be determined from the brand
+     * string: Xeon Bronze, Silver, and Gold 5xxx (except 5122 and 5222) have
+     * one unit, everything else has two.
+     */
+    char brand[49] = {0};
+    uint32_t* regs = reinterpret_cast<uint32_t*>(brand);
+
+    if (__get_cpuid_max(0x80000000u, 0) < 0x80000004u) return 2;
+
+    for (unsigned leaf = 0;leaf < 3;leaf++)
+        __cpuid(0x80000002u+leaf, regs[4*leaf+0], regs[4*leaf+1],
+                                  regs[4*leaf+2], regs[4*leaf+3]);
+
+    //fprintf(stderr, "brand: %s\n", brand);
+
+    if (strstr(brand, "Bronze") || strstr(brand, "Silver")) return 1;
+
+    const char* gold = strstr(brand, "Gold");
+    if (gold)
+    {
+        const char* sku = gold+4;
+        while (*sku == ' ') sku++;
+
+        if (sku[0] == '5' &&
+            strncmp(sku, "5122", 4) != 0 &&
+            strncmp(sku, "5222", 4) != 0) return 1;
+    }
+
+    return 2;
+}
+
+int get_cores_per_l3()
+{
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+
+    if (vendor != VENDOR_AMD) return 0;
+
+    uint32_t eax, ebx, ecx, edx;
+
+    /*
+     * The cache topology leaf requires TOPOEXT (CPUID[EAX=0x80000001]:ECX[22]).
+     */
+    if (__get_cpuid_max(0x80000000u, 0) < 0x8000001Eu) return 0;
+
+    __cpuid(0x80000001u, eax, ebx, ecx, edx);
+    if (!(ecx&(1u<<22))) return 0;
+
+    /*
+     * The number of SMT threads per core is CPUID[EAX=0x8000001E]:EBX[15:8]+1.
+     */
+    __cpuid(0x8000001Eu, eax, ebx, ecx, edx);
+    int threads_per_core = ((ebx>>8)&0xFF)+1;
+
+    /*
+     * Find the L3 in CPUID[EAX=0x8000001D,ECX=i]: the type is in EAX[4:0] (0 if
+     * there are no more caches), the level in EAX[7:5], and the number of
+     * logical processors sharing the cache in EAX[25:14]+1.
+     */
+    for (unsigned i = 0;;i++)
+    {
+        __cpuid_count(0x8000001Du, i, eax, ebx, ecx, edx);
+
+        if ((eax&0x1F) == 0) break;
+        if (((eax>>5)&0x7) != 3) continue;
+
+        int sharing = ((eax>>14)&0xFFF)+1;
+
+        //fprintf(stderr, "l3 sharing: %d, threads per core: %d\n",
+        //        sharing, threads_per_core);
+
+        return sharing < threads_per_core ? 1 : sharing/threads_per_core;
+    }
+
+    return 0;
+}
+
+bool get_cache_info(unsigned i, int& type, int& level, len_type& size,
+                    int& line_size, int& ways, int& sharing)
+{
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+
+    uint32_t eax, ebx, ecx, edx;
+    unsigned leaf;
+
+    if (vendor == VENDOR_INTEL)
+    {
+        leaf = 4;
+        if (__get_cpuid_max(0, 0) < leaf) return false;
+    }
+    else if (vendor == VENDOR_AMD)
+    {
+        leaf = 0x8000001Du;
+        if (__get_cpuid_max(0x80000000u, 0) < leaf) return false;
+
+        __cpuid(0x80000001u, eax, ebx, ecx, edx);
+        if (!(ecx&(1u<<22))) return false;
+    }
+    else return false;
+
+    /*
+     * Both leaves have the same layout: the type is in EAX[4:0], the level in
+     * EAX[7:5], and the sharing in EAX[25:14]+1. The line size, number of
+     * partitions, and associativity are in EBX[11:0]+1, EBX[21:12]+1, and
+     * EBX[31:22]+1, and the number of sets is ECX+1.
+     */
+    __cpuid_count(leaf, i, eax, ebx, ecx, edx);
+
+    type = eax&0x1F;
+    if (type == 0) return false;
+
+    level = (eax>>5)&0x7;
+    sharing = ((eax>>14)&0xFFF)+1;
+    line_size = (ebx&0xFFF)+1;
+    ways = ((ebx>>22)&0x3FF)+1;
+    size = len_type(ways)*(((ebx>>12)&0x3FF)+1)*line_size*(len_type(ecx)+1);
+
+    return true;
+}
+
 }
 
 #elif defined(__aarch64__) || defined(__arm__) || defined(_M_ARM)
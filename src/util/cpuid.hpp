@@ -31,10 +31,34 @@ enum {FEATURE_SSE3     = 0x001,
       FEATURE_FMA4     = 0x080,
       FEATURE_AVX512F  = 0x100,
       FEATURE_AVX512PF = 0x200,
-      FEATURE_AVX512DQ = 0x400};
+      FEATURE_AVX512DQ = 0x400,
+      FEATURE_AVX512BW = 0x800,
+      FEATURE_AVX512VL = 0x1000};
 
 int get_cpu_type(int& family, int& model, int& features);
 
+/*
+ * The number of 512-bit FMA units per core, or 0 if AVX-512 is not
+ * available.
+ */
+int get_avx512_fma_units();
+
+/*
+ * The number of cores which share an L3 cache, or 0 if this cannot be
+ * determined. Currently only implemented for AMD processors.
+ */
+int get_cores_per_l3();
+
+/*
+ * Describe the i-th cache reported by the deterministic cache parameters leaf
+ * (CPUID[EAX=4] on Intel, CPUID[EAX=0x8000001D] on AMD). The type is 1 for
+ * data, 2 for instruction, and 3 for unified caches, and sharing is the
+ * (maximum) number of logical processors sharing the cache. Returns false if
+ * there is no such cache or the leaf is not supported.
+ */
+bool get_cache_info(unsigned i, int& type, int& level, len_type& size,
+                    int& line_size, int& ways, int& sharing);
+
 }
 
 #elif defined(__aarch64__) || defined(__arm__) || defined(_M_ARM)
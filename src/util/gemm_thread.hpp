@@ -3,46 +3,139 @@
 
 #include "basic_types.h"
 #include "env.hpp"
+#include "memory/alignment.hpp"
+#include "thread_tuning.hpp"
+#include "topology.hpp"
 
 namespace tblis
 {
 
+/*
+ * The number of ways that each loop of the gemm is split. pc_nt is the
+ * number of ways that k is split (split-K), in which case each gang of
+ * nthread/pc_nt threads computes its part of the product separately, and
+ * the results are summed by the caller.
+ */
 struct gemm_thread_config
 {
-    gemm_thread_config(int jc_nt_, int ic_nt_, int jr_nt_, int ir_nt_)
-    : jc_nt(jc_nt_), ic_nt(ic_nt_), jr_nt(jr_nt_), ir_nt(ir_nt_) {}
+    gemm_thread_config(int jc_nt_, int ic_nt_, int jr_nt_, int ir_nt_, int pc_nt_ = 1)
+    : jc_nt(jc_nt_), ic_nt(ic_nt_), jr_nt(jr_nt_), ir_nt(ir_nt_), pc_nt(pc_nt_) {}
 
     int jc_nt = 1;
     int ic_nt = 1;
     int jr_nt = 1;
     int ir_nt = 1;
+    int pc_nt = 1;
 };
 
+/*
+ * Choose how to split the gemm loops over nthread threads. k is only split
+ * if split_k is true, i.e. if the caller knows how to sum the partial
+ * results.
+ */
 template <typename T>
 gemm_thread_config make_gemm_thread_config(const config& cfg,
-    int nthread, len_type m, len_type n, len_type k)
+    int nthread, len_type m, len_type n, len_type k, bool split_k = false)
 {
     int ic_nt, jc_nt, ir_nt, jr_nt;
+    int pc_nt = 1;
+
+    /*
+     * Use a tuned configuration for this shape if there is one, otherwise
+     * fall back to the heuristic below.
+     */
+    tuned_thread_config tuned;
+    if (find_tuned_thread_config(cfg.name, type_tag<T>::value, nthread, m, n, k, tuned))
+    {
+        jc_nt = tuned.jc_nt;
+        ic_nt = tuned.ic_nt;
+        jr_nt = tuned.jr_nt;
+        ir_nt = tuned.ir_nt;
+    }
+    else
+    {
+        /*
+         * If C is too small to give every thread a few micro-tiles, but k is
+         * long, then split k as few ways as possible so that each gang has
+         * enough of C to work on. Each gang should still get at least one
+         * full KC block, otherwise the extra work of summing the partial
+         * results is not worth it.
+         */
+        if (split_k && nthread > 1)
+        {
+            len_type mn_tiles = ceil_div(m, cfg.gemm_mr.def<T>())*
+                                ceil_div(n, cfg.gemm_nr.def<T>());
+            len_type k_blocks = k/cfg.gemm_kc.def<T>();
 
-    std::tie(ic_nt, jc_nt) =
-        partition_2x2(nthread, m*cfg.m_thread_ratio.value<T>(),
-                               n*cfg.n_thread_ratio.value<T>());
+            for (pc_nt = 1;pc_nt < nthread;pc_nt++)
+                if (nthread%pc_nt == 0 && mn_tiles >= 4*(nthread/pc_nt)) break;
 
-    for (ir_nt = cfg.mr_max_thread.value<T>();ir_nt > 1;ir_nt--)
-    {
-        if (ic_nt%ir_nt == 0)
+            while (pc_nt > 1 && (nthread%pc_nt != 0 || k_blocks < pc_nt)) pc_nt--;
+        }
+
+        int nt = nthread/pc_nt;
+
+        /*
+         * If the last-level cache is split between groups of threads (e.g. the
+         * CCXs of AMD Zen, or separate sockets), then give each group its own
+         * part of the jc loop so that the packed panel of B is only shared by
+         * threads in the same group. Threads are ganged contiguously, so this
+         * requires that consecutive threads are placed in the same group.
+         *
+         * Unless the configuration knows better, the groups are taken from the
+         * machine topology: the cores sharing an L3, or the cores in a NUMA
+         * node if that is smaller. These are counted in cores, so if there
+         * are more threads than cores (i.e. SMT is used), then each group
+         * has correspondingly more threads.
+         */
+        int l3_nt = 0;
+        if (nt > 1)
         {
-            ic_nt /= ir_nt;
-            break;
+            auto& topo = get_topology();
+
+            if (cfg.l3_cores)
+            {
+                l3_nt = cfg.l3_cores();
+            }
+            else
+            {
+                l3_nt = topo.cores_per_cache(3);
+                int numa_nt = topo.cores_per_numa_node();
+                if (numa_nt > 0 && (l3_nt == 0 || numa_nt < l3_nt)) l3_nt = numa_nt;
+            }
+
+            int smt = std::min(topo.threads_per_core,
+                               std::max(1, nthread/topo.num_cores));
+            l3_nt *= smt;
         }
-    }
+        int l3_ngroup = 1;
 
-    for (jr_nt = cfg.nr_max_thread.value<T>();jr_nt > 1;jr_nt--)
-    {
-        if (jc_nt%jr_nt == 0)
+        if (l3_nt > 0 && nt > l3_nt && nt%l3_nt == 0 &&
+            n >= (nt/l3_nt)*cfg.gemm_nr.def<T>())
+            l3_ngroup = nt/l3_nt;
+
+        std::tie(ic_nt, jc_nt) =
+            partition_2x2(nt/l3_ngroup, m*cfg.m_thread_ratio.value<T>(),
+                                        n*cfg.n_thread_ratio.value<T>()/l3_ngroup);
+
+        jc_nt *= l3_ngroup;
+
+        for (ir_nt = cfg.mr_max_thread.value<T>();ir_nt > 1;ir_nt--)
         {
-            jc_nt /= jr_nt;
-            break;
+            if (ic_nt%ir_nt == 0)
+            {
+                ic_nt /= ir_nt;
+                break;
+            }
+        }
+
+        for (jr_nt = cfg.nr_max_thread.value<T>();jr_nt > 1;jr_nt--)
+        {
+            if (jc_nt%(jr_nt*l3_ngroup) == 0)
+            {
+                jc_nt /= jr_nt;
+                break;
+            }
         }
     }
 
@@ -50,10 +143,11 @@ gemm_thread_config make_gemm_thread_config(const config& cfg,
     ic_nt = envtol("BLIS_IC_NT", ic_nt);
     jr_nt = envtol("BLIS_JR_NT", jr_nt);
     ir_nt = envtol("BLIS_IR_NT", ir_nt);
+    if (split_k) pc_nt = envtol("BLIS_PC_NT", pc_nt);
 
-    TBLIS_ASSERT(ir_nt*jr_nt*ic_nt*jc_nt == nthread);
+    TBLIS_ASSERT(ir_nt*jr_nt*ic_nt*jc_nt*pc_nt == nthread);
 
-    return {jc_nt, ic_nt, jr_nt, ir_nt};
+    return {jc_nt, ic_nt, jr_nt, ir_nt, pc_nt};
 }
 
 template <int N> struct step_helper;
@@ -81,6 +175,35 @@ auto step(T& tree) -> decltype(step_helper<N>()(tree))
     return step_helper<N>()(tree);
 }
 
+template <typename T, typename=void>
+struct leaf_helper
+{
+    typedef T type;
+
+    T& operator()(T& tree) const { return tree; }
+};
+
+template <typename T>
+struct leaf_helper<T, decltype(std::declval<T&>().child, void())>
+{
+    typedef decltype(std::declval<T&>().child) child_type;
+    typedef typename leaf_helper<typename std::decay<child_type>::type>::type type;
+
+    type& operator()(T& tree) const
+    {
+        return leaf_helper<typename std::decay<child_type>::type>()(tree.child);
+    }
+};
+
+/*
+ * The last node of a control tree (i.e. the micro-kernel).
+ */
+template <typename T>
+typename leaf_helper<T>::type& leaf(T& tree)
+{
+    return leaf_helper<T>()(tree);
+}
+
 }
 
 #endif
@@ -1,15 +1,5 @@
 #include "thread.h"
-
-#include <cstdio>
-
-#if TBLIS_HAVE_SYSCTL
-#include <sys/types.h>
-#include <sys/sysctl.h>
-#endif
-
-#if TBLIS_HAVE_SYSCONF
-#include <unistd.h>
-#endif
+#include "topology.hpp"
 
 #if TBLIS_HAVE_HWLOC_H
 #include <hwloc.h>
@@ -48,32 +38,27 @@ struct thread_configuration
                 num_threads = hwloc_get_nbobjs_by_depth(topo, depth);
             }
 
-            hwloc_topology_destroy(topo);
-
-            #elif TBLIS_HAVE_LSCPU
-
-            FILE *fd = popen("lscpu --parse=core | grep '^[0-9]' | sort -rn | head -n 1", "r");
-
-            std::string s;
-            int c;
-            while ((c = fgetc(fd)) != EOF) s.push_back(c);
-
-            pclose(fd);
-
-            num_threads = strtol(s.c_str(), NULL, 10);
-
-            #elif TBLIS_HAVE_SYSCTL
-
-            size_t len = sizeof(num_threads);
-            sysctlbyname("hw.physicalcpu", &num_threads, &len, NULL, 0);
+            /*
+             * Only count the cores which this process may run on (at least
+             * partly).
+             */
+            hwloc_cpuset_t cpus = hwloc_bitmap_alloc();
+            if (hwloc_get_cpubind(topo, cpus, HWLOC_CPUBIND_PROCESS) == 0)
+            {
+                unsigned ncore = 0;
+                hwloc_obj_t core = nullptr;
+                while ((core = hwloc_get_next_obj_by_type(topo, HWLOC_OBJ_CORE, core)))
+                    if (hwloc_bitmap_intersects(core->cpuset, cpus)) ncore++;
 
-            #elif TBLIS_HAVE_SYSCONF && TBLIS_HAVE__SC_NPROCESSORS_ONLN
+                if (ncore > 0) num_threads = ncore;
+            }
+            hwloc_bitmap_free(cpus);
 
-            num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+            hwloc_topology_destroy(topo);
 
-            #elif TBLIS_HAVE_SYSCONF && TBLIS_HAVE__SC_NPROCESSORS_CONF
+            #else
 
-            num_threads = sysconf(_SC_NPROCESSORS_CONF);
+            num_threads = tblis::get_topology().num_cores;
 
             #endif
         }
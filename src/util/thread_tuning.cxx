@@ -0,0 +1,164 @@
+#include "thread_tuning.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
+namespace tblis
+{
+
+namespace
+{
+
+const char type_chars[] = "sdcz";
+
+typedef std::tuple<std::string,int,int,int,int,int> tuning_key;
+
+struct thread_tuning_table
+{
+    std::mutex lock;
+    std::map<tuning_key,tuned_thread_config> entries;
+    /*
+     * Allows lookups to skip the lock when there are no entries (the usual
+     * case).
+     */
+    std::atomic<bool> empty{true};
+
+    thread_tuning_table()
+    {
+        const char* file = getenv("TBLIS_THREAD_TUNING_FILE");
+        if (file) read(file);
+    }
+
+    bool read(const std::string& file)
+    {
+        std::ifstream ifs(file);
+        if (!ifs) return false;
+
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            std::istringstream iss(line);
+
+            std::string name;
+            if (!(iss >> name) || name[0] == '#') continue;
+
+            char type;
+            int nthread, m, n, k;
+            tuned_thread_config tc;
+            if (!(iss >> type >> nthread >> m >> n >> k >>
+                  tc.jc_nt >> tc.ic_nt >> tc.jr_nt >> tc.ir_nt)) continue;
+
+            const char* type_pos = strchr(type_chars, type);
+            if (!type_pos || !*type_pos) continue;
+
+            if (tc.jc_nt < 1 || tc.ic_nt < 1 || tc.jr_nt < 1 || tc.ir_nt < 1 ||
+                tc.jc_nt*tc.ic_nt*tc.jr_nt*tc.ir_nt != nthread) continue;
+
+            entries[tuning_key(name, type_pos-type_chars, nthread, m, n, k)] = tc;
+            empty = false;
+        }
+
+        return true;
+    }
+
+    bool write(const std::string& file)
+    {
+        std::ofstream ofs(file);
+        if (!ofs) return false;
+
+        ofs << "# config type nthread m n k jc_nt ic_nt jr_nt ir_nt\n";
+
+        for (auto& entry : entries)
+        {
+            auto& key = entry.first;
+            auto& tc = entry.second;
+
+            ofs << std::get<0>(key) << ' '
+                << type_chars[std::get<1>(key)] << ' '
+                << std::get<2>(key) << ' '
+                << std::get<3>(key) << ' '
+                << std::get<4>(key) << ' '
+                << std::get<5>(key) << ' '
+                << tc.jc_nt << ' ' << tc.ic_nt << ' '
+                << tc.jr_nt << ' ' << tc.ir_nt << '\n';
+        }
+
+        return bool(ofs);
+    }
+};
+
+thread_tuning_table& get_thread_tuning_table()
+{
+    static thread_tuning_table table;
+    return table;
+}
+
+tuning_key make_key(const std::string& cfg_name, type_t type, int nthread,
+                    len_type m, len_type n, len_type k)
+{
+    return tuning_key(cfg_name, type, nthread,
+                      thread_tuning_bucket(m),
+                      thread_tuning_bucket(n),
+                      thread_tuning_bucket(k));
+}
+
+}
+
+int thread_tuning_bucket(len_type len)
+{
+    return (len > 1 ? (int)std::lround(std::log2((double)len)) : 0);
+}
+
+bool find_tuned_thread_config(const std::string& cfg_name, type_t type,
+                              int nthread, len_type m, len_type n, len_type k,
+                              tuned_thread_config& tc)
+{
+    auto& table = get_thread_tuning_table();
+    if (table.empty) return false;
+
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    auto it = table.entries.find(make_key(cfg_name, type, nthread, m, n, k));
+    if (it == table.entries.end()) return false;
+
+    tc = it->second;
+    return true;
+}
+
+void set_tuned_thread_config(const std::string& cfg_name, type_t type,
+                             int nthread, len_type m, len_type n, len_type k,
+                             const tuned_thread_config& tc)
+{
+    TBLIS_ASSERT(tc.jc_nt*tc.ic_nt*tc.jr_nt*tc.ir_nt == nthread);
+
+    auto& table = get_thread_tuning_table();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    table.entries[make_key(cfg_name, type, nthread, m, n, k)] = tc;
+    table.empty = false;
+}
+
+bool load_thread_tuning(const std::string& file)
+{
+    auto& table = get_thread_tuning_table();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    return table.read(file);
+}
+
+bool save_thread_tuning(const std::string& file)
+{
+    auto& table = get_thread_tuning_table();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    return table.write(file);
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef _TBLIS_THREAD_TUNING_HPP_
+#define _TBLIS_THREAD_TUNING_HPP_
+
+#include <string>
+
+#include "basic_types.h"
+
+namespace tblis
+{
+
+/*
+ * A table of tuned gemm thread configurations, indexed by configuration name,
+ * data type, number of threads, and the (m, n, k) bucket of the problem. The
+ * bucket of a length is its base-2 logarithm rounded to the nearest integer,
+ * so that entries tuned at powers of two cover the shapes around them.
+ *
+ * The table is read from the file given by TBLIS_THREAD_TUNING_FILE (if any)
+ * the first time it is used. Each line of the file holds one entry:
+ *
+ *     <config> <type> <nthread> <m bucket> <n bucket> <k bucket> <jc> <ic> <jr> <ir>
+ *
+ * where type is one of s, d, c, or z. Blank lines and lines starting with #
+ * are ignored. The file may be generated with bin/tune.
+ */
+struct tuned_thread_config
+{
+    int jc_nt = 1;
+    int ic_nt = 1;
+    int jr_nt = 1;
+    int ir_nt = 1;
+};
+
+int thread_tuning_bucket(len_type len);
+
+/*
+ * Look up the tuned thread configuration for a problem. Returns false if there
+ * is no entry for this shape.
+ */
+bool find_tuned_thread_config(const std::string& cfg_name, type_t type,
+                              int nthread, len_type m, len_type n, len_type k,
+                              tuned_thread_config& tc);
+
+/*
+ * Add or replace the entry for the bucket that the given shape falls in.
+ */
+void set_tuned_thread_config(const std::string& cfg_name, type_t type,
+                             int nthread, len_type m, len_type n, len_type k,
+                             const tuned_thread_config& tc);
+
+/*
+ * Merge the entries in the given file into the table. Returns false if the
+ * file could not be read.
+ */
+bool load_thread_tuning(const std::string& file);
+
+/*
+ * Write the whole table to the given file. Returns false if the file could
+ * not be written.
+ */
+bool save_thread_tuning(const std::string& file);
+
+}
+
+#endif
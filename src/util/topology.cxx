@@ -0,0 +1,308 @@
+#include "topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "tblis_config.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
+#define TBLIS_TOPOLOGY_CPUID 1
+#include "cpuid.hpp"
+#endif
+
+#if TBLIS_HAVE_SYSCTL
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
+#if TBLIS_HAVE_SYSCONF
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace tblis
+{
+
+namespace
+{
+
+const std::string sysfs_cpu = "/sys/devices/system/cpu/";
+const std::string sysfs_node = "/sys/devices/system/node/";
+
+bool read_line(const std::string& file, std::string& line)
+{
+    std::ifstream ifs(file);
+    return ifs && std::getline(ifs, line);
+}
+
+bool read_int(const std::string& file, long& value)
+{
+    std::ifstream ifs(file);
+    return ifs && (ifs >> value);
+}
+
+/*
+ * Parse a list of processors such as "0-3,8,10-11".
+ */
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+
+        std::string item = list.substr(pos, end-pos);
+        size_t dash = item.find('-');
+
+        try
+        {
+            int from = std::stoi(item.substr(0, dash));
+            int to = (dash == std::string::npos ? from : std::stoi(item.substr(dash+1)));
+            for (int cpu = from;cpu <= to;cpu++) cpus.push_back(cpu);
+        }
+        catch (...) {}
+
+        pos = end+1;
+    }
+
+    return cpus;
+}
+
+/*
+ * The processors in the list which this process may run on (because of its
+ * affinity mask or cpuset), or all of them if this cannot be determined.
+ */
+std::vector<int> allowed_cpus(const std::vector<int>& cpus)
+{
+    #ifdef __linux__
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0) return cpus;
+
+    std::vector<int> allowed;
+    for (int cpu : cpus)
+        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &mask)) allowed.push_back(cpu);
+
+    return allowed;
+
+    #else
+
+    return cpus;
+
+    #endif
+}
+
+/*
+ * Parse a cache size such as "32K" or "30M".
+ */
+len_type parse_size(const std::string& str)
+{
+    len_type size = 0;
+    size_t pos = 0;
+    while (pos < str.size() && isdigit(str[pos])) size = 10*size + (str[pos++]-'0');
+
+    if (pos < str.size())
+    {
+        switch (str[pos])
+        {
+            case 'K': size <<= 10; break;
+            case 'M': size <<= 20; break;
+            case 'G': size <<= 30; break;
+        }
+    }
+
+    return size;
+}
+
+void read_cpus(topology& topo)
+{
+    std::string line;
+    std::vector<int> cpus;
+    if (read_line(sysfs_cpu + "online", line)) cpus = parse_cpu_list(line);
+
+    auto allowed = allowed_cpus(cpus);
+    if (!allowed.empty()) cpus.swap(allowed);
+
+    if (!cpus.empty())
+    {
+        std::set<std::tuple<long,long,long>> cores;
+        std::set<long> packages;
+
+        for (int cpu : cpus)
+        {
+            std::string dir = sysfs_cpu + "cpu" + std::to_string(cpu) + "/topology/";
+
+            long package = 0, die = 0, core = cpu;
+            read_int(dir + "physical_package_id", package);
+            read_int(dir + "die_id", die);
+            read_int(dir + "core_id", core);
+
+            cores.emplace(package, die, core);
+            packages.insert(package);
+        }
+
+        topo.num_cpus = cpus.size();
+        topo.num_cores = cores.size();
+        topo.num_packages = packages.size();
+    }
+    else
+    {
+        #if TBLIS_HAVE_SYSCTL
+
+        int ncpu = 0, ncore = 0;
+        size_t len = sizeof(int);
+        if (sysctlbyname("hw.logicalcpu", &ncpu, &len, NULL, 0) == 0 && ncpu > 0)
+            topo.num_cpus = ncpu;
+        len = sizeof(int);
+        if (sysctlbyname("hw.physicalcpu", &ncore, &len, NULL, 0) == 0 && ncore > 0)
+            topo.num_cores = ncore;
+        else
+            topo.num_cores = topo.num_cpus;
+
+        #elif TBLIS_HAVE_SYSCONF && TBLIS_HAVE__SC_NPROCESSORS_ONLN
+
+        topo.num_cpus = topo.num_cores = std::max(1l, sysconf(_SC_NPROCESSORS_ONLN));
+
+        #elif TBLIS_HAVE_SYSCONF && TBLIS_HAVE__SC_NPROCESSORS_CONF
+
+        topo.num_cpus = topo.num_cores = std::max(1l, sysconf(_SC_NPROCESSORS_CONF));
+
+        #endif
+    }
+
+    topo.threads_per_core = std::max(1, topo.num_cpus/topo.num_cores);
+}
+
+void read_caches(topology& topo)
+{
+    for (int i = 0;;i++)
+    {
+        std::string dir = sysfs_cpu + "cpu0/cache/index" + std::to_string(i) + "/";
+
+        std::string type;
+        if (!read_line(dir + "type", type)) break;
+        if (type == "Instruction") continue;
+
+        cache_info cache;
+        long value;
+        std::string line;
+
+        if (read_int(dir + "level", value)) cache.level = value;
+        if (read_line(dir + "size", line)) cache.size = parse_size(line);
+        if (read_int(dir + "coherency_line_size", value)) cache.line_size = value;
+        if (read_int(dir + "ways_of_associativity", value)) cache.ways = value;
+        if (read_line(dir + "shared_cpu_list", line)) cache.sharing = parse_cpu_list(line).size();
+
+        if (cache.level > 0 && cache.size > 0) topo.caches.push_back(cache);
+    }
+
+    #if TBLIS_TOPOLOGY_CPUID
+
+    if (topo.caches.empty())
+    {
+        int type;
+        cache_info cache;
+        for (unsigned i = 0;get_cache_info(i, type, cache.level, cache.size,
+                                           cache.line_size, cache.ways,
+                                           cache.sharing);i++)
+        {
+            /*
+             * The sharing reported by CPUID is an upper bound.
+             */
+            cache.sharing = std::min(cache.sharing, topo.num_cpus);
+            if (type != 2) topo.caches.push_back(cache);
+        }
+    }
+
+    #endif
+
+    std::stable_sort(topo.caches.begin(), topo.caches.end(),
+                     [](const cache_info& a, const cache_info& b)
+                     { return a.level < b.level; });
+}
+
+void read_numa_nodes(topology& topo)
+{
+    std::string line;
+    if (read_line(sysfs_node + "online", line))
+    {
+        for (int node : parse_cpu_list(line))
+        {
+            std::string cpus;
+            if (!read_line(sysfs_node + "node" + std::to_string(node) + "/cpulist", cpus))
+                continue;
+
+            /*
+             * Skip nodes which only have memory, or none of whose processors
+             * may be used.
+             */
+            auto list = allowed_cpus(parse_cpu_list(cpus));
+            if (!list.empty()) topo.numa_nodes.push_back(list);
+        }
+    }
+
+    if (topo.numa_nodes.empty())
+    {
+        topo.numa_nodes.emplace_back();
+        for (int cpu = 0;cpu < topo.num_cpus;cpu++)
+            topo.numa_nodes.back().push_back(cpu);
+    }
+}
+
+struct topology_init
+{
+    topology topo;
+
+    topology_init()
+    {
+        read_cpus(topo);
+        read_caches(topo);
+        read_numa_nodes(topo);
+    }
+};
+
+}
+
+const cache_info* topology::cache(int level) const
+{
+    for (auto& cache : caches)
+        if (cache.level == level) return &cache;
+
+    return nullptr;
+}
+
+int topology::cores_per_cache(int level) const
+{
+    auto c = cache(level);
+    if (!c || c->sharing <= 0) return 0;
+    return std::max(1, c->sharing/threads_per_core);
+}
+
+int topology::cores_per_numa_node() const
+{
+    if (numa_nodes.size() <= 1) return 0;
+
+    for (auto& node : numa_nodes)
+        if (node.size() != numa_nodes[0].size()) return 0;
+
+    return std::max<int>(1, numa_nodes[0].size()/threads_per_core);
+}
+
+const topology& get_topology()
+{
+    static topology_init init;
+    return init.topo;
+}
+
+}
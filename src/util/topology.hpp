@@ -0,0 +1,73 @@
+#ifndef _TBLIS_TOPOLOGY_HPP_
+#define _TBLIS_TOPOLOGY_HPP_
+
+#include <vector>
+
+#include "basic_types.h"
+
+namespace tblis
+{
+
+/*
+ * A data or unified cache. Sizes are in bytes, and sharing is the number of
+ * logical processors which share one instance of the cache (0 if unknown).
+ */
+struct cache_info
+{
+    int level = 0;
+    len_type size = 0;
+    int line_size = 0;
+    int ways = 0;
+    int sharing = 0;
+};
+
+/*
+ * The processor and memory topology of the machine. This is read once, the
+ * first time it is used, from /sys/devices/system/{cpu,node} where available.
+ * Cache parameters fall back to CPUID on x86, and the processor count to
+ * sysctl or sysconf elsewhere. Anything which cannot be determined is left at
+ * a neutral default (one core per processor, no caches, one NUMA node).
+ *
+ * On Linux, only the processors in the affinity mask of the process (which
+ * also reflects its cpuset) are counted.
+ */
+struct topology
+{
+    int num_cpus = 1;
+    int num_cores = 1;
+    int num_packages = 1;
+    int threads_per_core = 1;
+
+    /*
+     * Data and unified caches, ordered by level.
+     */
+    std::vector<cache_info> caches;
+
+    /*
+     * The logical processors in each NUMA node.
+     */
+    std::vector<std::vector<int>> numa_nodes;
+
+    /*
+     * The cache at the given level, or nullptr if it is not known.
+     */
+    const cache_info* cache(int level) const;
+
+    /*
+     * The number of cores which share one instance of the cache at the given
+     * level, or 0 if this cannot be determined.
+     */
+    int cores_per_cache(int level) const;
+
+    /*
+     * The number of cores in each NUMA node, or 0 if there is only one node
+     * or the nodes are not all the same size.
+     */
+    int cores_per_numa_node() const;
+};
+
+const topology& get_topology();
+
+}
+
+#endif
@@ -130,6 +130,14 @@ void passfail(const string& label, T a, U b, double ulps)
     passfail(label, 0, 0, a, b, ulps);
 }
 
+template <typename Tensor>
+void conjugate(Tensor& A)
+{
+    auto data = A.data();
+    MArray::viterator<> it(A.lengths(), A.strides());
+    while (it.next(data)) *data = tblis::conj(*data);
+}
+
 template <typename T> const string& type_name();
 
 template <> const string& type_name<float>()
@@ -958,6 +966,132 @@ void test_tblis(stride_type N)
         T error = reduce(REDUCE_NORM_2, E).first;
 
         passfail("REF", error, 0, ulp_factor*ceil2(scale*m*n*k));
+
+        matrix<T> Ac(A), Bc(B);
+        conjugate(Ac);
+        conjugate(Bc);
+        D.reset(C);
+        conjugate(D);
+        gemm_ref(scale, Ac, Bc, scale, D);
+
+        E.reset(C);
+        tblis_matrix A_s(scale, A);
+        tblis_matrix B_s(B);
+        tblis_matrix C_s(scale, E);
+        A_s.conj = B_s.conj = C_s.conj = true;
+        tblis_matrix_mult(nullptr, nullptr, &A_s, &B_s, &C_s);
+
+        add(T(-1), D, T(1), E);
+        error = reduce(REDUCE_NORM_2, E).first;
+
+        passfail("CONJ", error, 0, ulp_factor*ceil2(scale*m*n*k));
+
+        /*
+         * Use a copy of the default config with small random cache blocksizes
+         * and thread ratios, so that all of the partitioning is exercised.
+         */
+        tblis_config* cfg = tblis_clone_config(nullptr);
+        const config& cfg_def = get_default_config();
+        type_t type = type_tag<T>::value;
+        len_type MR = cfg_def.gemm_mr.def<T>();
+        len_type NR = cfg_def.gemm_nr.def<T>();
+        len_type KR = cfg_def.gemm_kr.def<T>();
+        len_type MC = MR*random_number(1, 4);
+        len_type NC = NR*random_number(1, 4);
+        len_type KC = KR*random_number(1, 16);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_MC, type, MC, MC+MR);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_NC, type, NC, NC);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_KC, type, KC, KC+KR);
+        tblis_config_set_parameter(cfg, TBLIS_M_THREAD_RATIO, type, random_number(1, 3));
+
+        D.reset(C);
+        gemm_ref(scale, A, B, scale, D);
+
+        E.reset(C);
+        tblis_matrix A_t(scale, A);
+        tblis_matrix B_t(B);
+        tblis_matrix C_t(scale, E);
+        tblis_matrix_mult(nullptr, cfg, &A_t, &B_t, &C_t);
+        tblis_free_config(cfg);
+
+        add(T(-1), D, T(1), E);
+        error = reduce(REDUCE_NORM_2, E).first;
+
+        passfail("CONFIG", error, 0, ulp_factor*ceil2(scale*m*n*k));
+
+        /*
+         * Split k between two threads: C is at most one micro-tile, and k is
+         * at least two (small) KC blocks long.
+         */
+        cfg = tblis_clone_config(nullptr);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_KC, type, KC, KC+KR);
+
+        len_type m_k = random_number<len_type>(1, MR);
+        len_type n_k = random_number<len_type>(1, NR);
+        len_type k_k = random_number<len_type>(2*KC, 4*KC);
+        matrix<T> A_k({m_k, k_k}), B_k({k_k, n_k}), C_k({m_k, n_k});
+        for (auto M : {&A_k, &B_k, &C_k})
+        {
+            T* data = M->data();
+            MArray::miterator<2> it(M->lengths(), M->strides());
+            while (it.next(data)) *data = random_unit<T>();
+        }
+
+        D.reset(C_k);
+        gemm_ref(scale, A_k, B_k, scale, D);
+
+        E.reset(C_k);
+        parallelize
+        (
+            [&](const communicator& comm)
+            {
+                tblis_matrix A_s(scale, A_k);
+                tblis_matrix B_s(B_k);
+                tblis_matrix C_s(scale, E);
+                tblis_matrix_mult(comm, cfg, &A_s, &B_s, &C_s);
+            },
+            2
+        );
+        tblis_free_config(cfg);
+
+        add(T(-1), D, T(1), E);
+        error = reduce(REDUCE_NORM_2, E).first;
+
+        passfail("SPLIT_K", error, 0, ulp_factor*ceil2(scale*m_k*n_k*k_k));
+
+        /*
+         * Hand out small cache blocks dynamically to four threads. The
+         * threads may not be used along the register blocksizes, so that
+         * they all go to the m and n partitions.
+         */
+        cfg = tblis_clone_config(nullptr);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_MC, type, MC, MC+MR);
+        tblis_config_set_blocksize(cfg, TBLIS_GEMM_NC, type, NC, NC);
+        tblis_config_set_parameter(cfg, TBLIS_MR_MAX_THREAD, type, 1);
+        tblis_config_set_parameter(cfg, TBLIS_NR_MAX_THREAD, type, 1);
+        tblis_config_set_parameter(cfg, TBLIS_DYNAMIC_PARTITION, type, 1);
+
+        D.reset(C);
+        gemm_ref(scale, A, B, scale, D);
+
+        E.reset(C);
+        parallelize
+        (
+            [&](const communicator& comm)
+            {
+                tblis_matrix A_s(scale, A);
+                tblis_matrix B_s(B);
+                tblis_matrix C_s(scale, E);
+                tblis_matrix_mult(comm, cfg, &A_s, &B_s, &C_s);
+            },
+            4
+        );
+        tblis_free_config(cfg);
+
+        add(T(-1), D, T(1), E);
+        error = reduce(REDUCE_NORM_2, E).first;
+
+        passfail("DYNAMIC", error, 0, ulp_factor*ceil2(scale*m*n*k));
     }
 }
 
@@ -1007,6 +1141,133 @@ void test_mult(stride_type N)
     T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
 
     passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    /*
+     * The remaining checks compare against the reference implementation.
+     */
+    impl = REFERENCE;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    impl = BLIS_BASED;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("BLIS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    auto plan = mult_plan<T>(A, idx_A.data(), B, idx_B.data(), C, idx_C.data());
+
+    /*
+     * The second execution reuses the layout cached by the first, and the
+     * last one runs on a team of threads which all execute the plan at once.
+     */
+    for (int rep = 0;rep < 5;rep++)
+    {
+        if (rep == 2) tblis_tensor_mult_plan_set_impl(plan, SMALL_TENSOR);
+        if (rep == 3) tblis_tensor_mult_plan_set_impl(plan, AUTOMATIC);
+
+        E.reset(C);
+
+        if (rep == 4)
+        {
+            parallelize
+            (
+                [&](const communicator& comm)
+                {
+                    tblis_scalar scale_s(scale);
+                    tblis_tensor_mult_execute(comm, nullptr, plan,
+                                              &scale_s, A.data(), B.data(),
+                                              &scale_s, E.data());
+                },
+                2
+            );
+        }
+        else
+        {
+            mult(plan, scale, A.data(), B.data(), scale, E.data());
+        }
+
+        add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+        error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+        passfail("PLAN", error, 0, ulp_factor*ceil2(scale*neps));
+    }
+
+    TBLIS_ASSERT(tblis_tensor_mult_plan_get_impl(plan) != AUTOMATIC);
+    tblis_tensor_mult_plan_destroy(plan);
+
+    tensor<T> Ac(A), Bc(B);
+    conjugate(Ac);
+    conjugate(Bc);
+
+    impl = REFERENCE;
+    D.reset(C);
+    conjugate(D);
+    mult(scale, Ac, idx_A.data(), Bc, idx_B.data(), scale, D, idx_C.data());
+
+    impl = BLIS_BASED;
+    E.reset(C);
+    const_tensor_view<T> Av(A), Bv(B);
+    tensor_view<T> Ev(E);
+    tblis_tensor A_s(scale, Av);
+    tblis_tensor B_s(Bv);
+    tblis_tensor C_s(scale, Ev);
+    A_s.conj = B_s.conj = C_s.conj = true;
+    tblis_tensor_mult(nullptr, nullptr, &A_s, idx_A.data(), &B_s, idx_B.data(),
+                      &C_s, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("CONJ", error, 0, ulp_factor*ceil2(scale*neps));
+
+    unsigned ndim_C = C.dimension();
+    auto epilogue = [](T& c) { c = T(2)*c + T(1); };
+    auto epilogue_indexed = [&](T& c, const len_type* pos)
+    {
+        for (unsigned i = 0;i < ndim_C;i++) c += T((i+1)*pos[i]);
+    };
+
+    impl = REFERENCE;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    tensor<T> F(D);
+    MArray::viterator<1> iter_D(D.lengths(), D.strides());
+    MArray::viterator<1> iter_F(F.lengths(), F.strides());
+    T* p_D = D.data();
+    T* p_F = F.data();
+    while (iter_D.next(p_D)) epilogue(*p_D);
+    while (iter_F.next(p_F))
+    {
+        std::vector<len_type> pos(iter_F.position().begin(), iter_F.position().end());
+        epilogue_indexed(*p_F, pos.data());
+    }
+
+    for (impl_t epilogue_impl : {REFERENCE, BLIS_BASED})
+    {
+        impl = epilogue_impl;
+        E.reset(C);
+        mult_epilogue(scale, A, idx_A.data(), B, idx_B.data(),
+                      scale, E, idx_C.data(), epilogue);
+
+        add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+        error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+        passfail("EPILOGUE", error, 0, ulp_factor*ceil2(2*scale*neps));
+
+        E.reset(C);
+        mult_epilogue_indexed(scale, A, idx_A.data(), B, idx_B.data(),
+                              scale, E, idx_C.data(), epilogue_indexed);
+
+        add(T(-1), F, idx_C.data(), T(1), E, idx_C.data());
+        error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+        passfail("INDEXED", error, 0, ulp_factor*ceil2(scale*neps));
+    }
 }
 
 template <typename T>
@@ -1058,6 +1319,311 @@ void test_contract(stride_type N)
     error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
 
     passfail("BLIS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    /*
+     * Repeat with small cache blocks handed out dynamically to four threads,
+     * as in test_tblis.
+     */
+    tblis_config* cfg = tblis_clone_config(nullptr);
+    const config& cfg_def = get_default_config();
+    type_t type = type_tag<T>::value;
+    len_type MC = cfg_def.gemm_mr.def<T>()*random_number(1, 4);
+    len_type NC = cfg_def.gemm_nr.def<T>()*random_number(1, 4);
+    tblis_config_set_blocksize(cfg, TBLIS_GEMM_MC, type, MC, MC);
+    tblis_config_set_blocksize(cfg, TBLIS_GEMM_NC, type, NC, NC);
+    tblis_config_set_parameter(cfg, TBLIS_MR_MAX_THREAD, type, 1);
+    tblis_config_set_parameter(cfg, TBLIS_NR_MAX_THREAD, type, 1);
+    tblis_config_set_parameter(cfg, TBLIS_DYNAMIC_PARTITION, type, 1);
+
+    E.reset(C);
+    parallelize
+    (
+        [&](const communicator& comm)
+        {
+            const_tensor_view<T> Ad(A), Bd(B);
+            tensor_view<T> Ed(E);
+            tblis_tensor A_d(scale, Ad);
+            tblis_tensor B_d(Bd);
+            tblis_tensor C_d(scale, Ed);
+            tblis_tensor_mult(comm, cfg, &A_d, idx_A.data(), &B_d, idx_B.data(),
+                              &C_d, idx_C.data());
+        },
+        4
+    );
+    tblis_free_config(cfg);
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("DYNAMIC", error, 0, ulp_factor*ceil2(scale*neps));
+
+    tensor<T> Ac(A), Bc(B);
+    conjugate(Ac);
+    conjugate(Bc);
+
+    T scale2(10.0*random_unit<T>());
+
+    impl = REFERENCE;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+    mult(scale2, Ac, idx_A.data(), Bc, idx_B.data(), T(1), D, idx_C.data());
+
+    E.reset(C);
+    tensor<T> A2(A), B2(B);
+    const_tensor_view<T> Av(A), Bv(B), A2v(A2), B2v(B2);
+    tensor_view<T> Ev(E);
+    tblis_tensor A_s[2] = {{scale, Av}, {scale2, A2v}};
+    tblis_tensor B_s[2] = {{Bv}, {B2v}};
+    tblis_tensor C_s(scale, Ev);
+    A_s[1].conj = B_s[1].conj = true;
+    const tblis_tensor* A_p[2] = {&A_s[0], &A_s[1]};
+    const tblis_tensor* B_p[2] = {&B_s[0], &B_s[1]};
+    const label_type* idx_A_p[2] = {idx_A.data(), idx_A.data()};
+    const label_type* idx_B_p[2] = {idx_B.data(), idx_B.data()};
+    tblis_tensor_mult_sum(nullptr, nullptr, 2, A_p, idx_A_p, B_p, idx_B_p,
+                          &C_s, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("SUM", error, 0, ulp_factor*ceil2(2*scale*neps));
+
+    /*
+     * With no terms, C is only scaled.
+     */
+    D.reset(C);
+    tblis::scale(scale, D, idx_C.data());
+
+    E.reset(C);
+    tensor_view<T> E0v(E);
+    tblis_tensor C_0(scale, E0v);
+    tblis_tensor_mult_sum(nullptr, nullptr, 0, nullptr, nullptr, nullptr, nullptr,
+                          &C_0, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("EMPTY_SUM", error, 0, ulp_factor*ceil2(scale*prod(C.lengths())));
+}
+
+/*
+ * Check the implementation chosen by the cost model on either side of each
+ * point where the choice changes, for matrix-like contractions (with and
+ * without a unit-stride index or an index summed over A only) and for outer
+ * products.
+ */
+template <typename T>
+void test_select_impl()
+{
+    const config& cfg = get_config(nullptr);
+    unsigned nt = tblis_get_num_threads();
+    impl_t old_impl = impl;
+    len_type s_max = 256;
+    label_type idx_A[] = {'a', 'c', 'd'};
+    label_type idx_B[] = {'c', 'b'};
+    label_type idx_C[] = {'a', 'b'};
+
+    T scale(10.0*random_unit<T>());
+
+    cout << endl;
+    cout << "Testing select_impl (" << type_name<T>() << "):" << endl;
+    cout << endl;
+
+    for (int shape = 0;shape < 4;shape++)
+    {
+        /*
+         * shape 0: C_ab = A_ac B_cb, column-major
+         * shape 1: the same, but with every stride doubled
+         * shape 2: C_ab = A_a B_b
+         * shape 3: C_ab = A_acd B_cb, where d has length 2
+         */
+        bool outer = shape == 2;
+        stride_type st = shape == 1 ? 2 : 1;
+        len_type d = shape == 3 ? 2 : 1;
+
+        auto choose = [&](len_type s)
+        {
+            std::vector<len_type> len_AB = {s}, len_AC = {s}, len_BC = {s};
+            std::vector<stride_type> stride_A_AB = {st*s}, stride_A_AC = {st};
+            std::vector<stride_type> stride_B_AB = {st}, stride_B_BC = {st*s};
+            std::vector<stride_type> stride_C_AC = {st}, stride_C_BC = {st*s};
+            std::vector<len_type> len_A;
+            std::vector<stride_type> stride_A_A;
+
+            if (d > 1)
+            {
+                len_A = {d};
+                stride_A_A = {s*s};
+            }
+
+            if (outer)
+            {
+                len_AB.clear();
+                stride_A_AB.clear();
+                stride_B_AB.clear();
+                stride_A_AC = {1};
+                stride_B_BC = {1};
+            }
+
+            return select_impl<T>(cfg, nt, len_A, {}, {},
+                                  len_AB, len_AC, len_BC, {},
+                                  stride_A_A, stride_A_AB, stride_A_AC, {},
+                                  {}, stride_B_AB, stride_B_BC, {},
+                                  {}, stride_C_AC, stride_C_BC, {});
+        };
+
+        auto check = [&](len_type s, impl_t expected)
+        {
+            double flops = double(s)*s*(outer ? 1 : s);
+            TBLIS_ASSERT((expected == SMALL_TENSOR) ==
+                         (d == 1 && 2*flops < small_tensor_flops));
+
+            std::vector<len_type> len_A = {s, s}, len_B = {s, s}, len_C = {s, s};
+            std::vector<stride_type> stride_A = {st, st*s}, stride_B = {st, st*s};
+            std::vector<stride_type> stride_C = {st, st*s};
+
+            if (d > 1)
+            {
+                len_A.push_back(d);
+                stride_A.push_back(s*s);
+            }
+
+            if (outer)
+            {
+                len_A = len_B = {s};
+                stride_A = stride_B = {1};
+            }
+
+            len_type size = st*s*s;
+            tensor<T> A({d*size}), B({size}), C({size});
+            for (auto X : {&A, &B, &C})
+                for (len_type i = 0;i < X->length(0);i++)
+                    X->data()[i] = random_unit<T>();
+            tensor<T> D(C), E(C), F(C);
+
+            const_tensor_view<T> Av(len_A, A.data(), stride_A);
+            const_tensor_view<T> Bv(len_B, B.data(), stride_B);
+            tensor_view<T> Dv(len_C, D.data(), stride_C);
+            tensor_view<T> Ev(len_C, E.data(), stride_C);
+            tensor_view<T> Fv(len_C, F.data(), stride_C);
+            const label_type* idx_Bp = outer ? idx_B+1 : idx_B;
+
+            impl = REFERENCE;
+            mult(scale, Av, idx_A, Bv, idx_Bp, scale, Dv, idx_C);
+
+            impl = BLAS_BASED;
+            mult(scale, Av, idx_A, Bv, idx_Bp, scale, Fv, idx_C);
+
+            impl = AUTOMATIC;
+            auto plan = mult_plan<T>(Av, idx_A, Bv, idx_Bp, Ev, idx_C);
+            mult(plan, scale, A.data(), B.data(), scale, E.data());
+            TBLIS_ASSERT(tblis_tensor_mult_plan_get_impl(plan) == expected);
+            tblis_tensor_mult_plan_destroy(plan);
+
+            auto neps = ceil2(flops*d);
+
+            add(T(-1), const_tensor_view<T>(Dv), idx_C, T(1), Fv, idx_C);
+            T error = reduce(REDUCE_NORM_2, const_tensor_view<T>(Fv), idx_C).first;
+            passfail("SELECT_BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+
+            add(T(-1), const_tensor_view<T>(Dv), idx_C, T(1), Ev, idx_C);
+            error = reduce(REDUCE_NORM_2, const_tensor_view<T>(Ev), idx_C).first;
+            passfail("SELECT_AUTO", error, 0, ulp_factor*ceil2(scale*neps));
+        };
+
+        /*
+         * Only check the first change between each pair of implementations,
+         * since the choice between the BLIS- and BLAS-based paths flips back
+         * and forth with the edge cases of the blocking.
+         */
+        std::vector<std::pair<impl_t,impl_t>> seen;
+        impl_t last = choose(1);
+        for (len_type s = 2;s <= s_max;s++)
+        {
+            impl_t next = choose(s);
+            if (next == last) continue;
+
+            auto change = std::make_pair(last, next);
+            if (std::find(seen.begin(), seen.end(), change) == seen.end())
+            {
+                cout << "shape " << shape << ": impl " << last << " -> " << next
+                     << " at " << s << endl;
+
+                check(s-1, last);
+                check(s, next);
+                seen.push_back(change);
+            }
+
+            last = next;
+        }
+    }
+
+    impl = old_impl;
+}
+
+template <typename T>
+void test_network(stride_type N)
+{
+    tensor<T> A, B, C, D, E, F, X;
+    std::vector<label_type> idx_A, idx_B, idx_C;
+
+    random_contract(N, A, idx_A, B, idx_B, C, idx_C);
+
+    T scale(10.0*random_unit<T>());
+
+    cout << endl;
+    cout << "Testing network (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << "len_C    = " << C.lengths() << endl;
+    cout << "stride_C = " << C.strides() << endl;
+    cout << "idx_C    = " << idx_C << endl;
+    cout << endl;
+
+    auto idx_AB = intersection(idx_A, idx_B);
+
+    auto neps = ceil2(prod(select_from(A.lengths(), idx_A, idx_AB))*
+                      prod(C.lengths()));
+
+    X.reset(C);
+
+    impl = REFERENCE;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), T(0), D, idx_C.data());
+    T ref_val = dot(D, idx_C.data(), X, idx_C.data());
+    F.reset(C);
+    mult(T(1), D, idx_C.data(), X, idx_C.data(), T(0), F, idx_C.data());
+
+    impl = AUTOMATIC;
+    const_tensor_view<T> Av(A), Bv(B), Xv(X);
+    tblis_tensor A_s[3] = {{scale, Av}, {Bv}, {Xv}};
+    const tblis_tensor* A_p[3] = {&A_s[0], &A_s[1], &A_s[2]};
+    const label_type* idx_A_p[3] = {idx_A.data(), idx_B.data(), idx_C.data()};
+
+    E.reset(C);
+    tensor_view<T> Ev(E);
+    tblis_tensor C_s(T(0), Ev);
+    tblis_tensor_contract_network(nullptr, nullptr, 3, A_p, idx_A_p,
+                                  &C_s, idx_C.data());
+
+    add(T(-1), F, idx_C.data(), T(1), E, idx_C.data());
+    T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("HADAMARD", error, 0, ulp_factor*ceil2(scale*neps));
+
+    T calc_val;
+    tblis_tensor S_s;
+    S_s.type = type_tag<T>::value;
+    S_s.scalar = tblis_scalar(T(0));
+    S_s.data = &calc_val;
+    tblis_tensor_contract_network(nullptr, nullptr, 3, A_p, idx_A_p,
+                                  &S_s, nullptr);
+
+    passfail("SCALAR", ref_val, calc_val, ulp_factor*ceil2(scale*neps));
 }
 
 template <typename T>
@@ -1085,11 +1651,11 @@ void test_weight(stride_type N)
 
     T scale(10.0*random_unit<T>());
 
-    impl = BLAS_BASED;
+    impl = REFERENCE;
     D.reset(C);
     mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
 
-    impl = REFERENCE;
+    impl = BLAS_BASED;
     E.reset(C);
     mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
 
@@ -1097,6 +1663,15 @@ void test_weight(stride_type N)
     T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
 
     passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    impl = BLIS_BASED;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("BLIS", error, 0, ulp_factor*ceil2(scale*neps));
 }
 
 template <typename T>
@@ -1124,11 +1699,11 @@ void test_outer_prod(stride_type N)
 
     T scale(10.0*random_unit<T>());
 
-    impl = BLAS_BASED;
+    impl = REFERENCE;
     D.reset(C);
     mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
 
-    impl = REFERENCE;
+    impl = BLAS_BASED;
     E.reset(C);
     mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
 
@@ -1136,6 +1711,15 @@ void test_outer_prod(stride_type N)
     T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
 
     passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    impl = BLIS_BASED;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("BLIS", error, 0, ulp_factor*ceil2(scale*neps));
 }
 
 template <typename T>
@@ -1480,6 +2064,8 @@ void test(stride_type N_in_bytes, int R)
     for (int i = 0;i < R;i++) test_weight<T>(N);
     for (int i = 0;i < R;i++) test_contract<T>(N);
     for (int i = 0;i < R;i++) test_mult<T>(N);
+    for (int i = 0;i < R;i++) test_network<T>(N);
+    test_select_impl<T>();
 }
 
 int main(int argc, char **argv)
@@ -0,0 +1,267 @@
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <iostream>
+#include <getopt.h>
+#include <sstream>
+#include <vector>
+
+#include "tblis.h"
+#include "util/time.hpp"
+#include "util/random.hpp"
+#include "configs/configs.hpp"
+#include "util/gemm_thread.hpp"
+#include "util/thread_tuning.hpp"
+
+/*
+ * Tune the gemm thread configuration for a set of problem shapes on this
+ * machine, and store the best configuration for each shape in a tuning file
+ * that can be read at runtime through TBLIS_THREAD_TUNING_FILE.
+ *
+ * Shapes are read from stdin, one per line, as:
+ *
+ *     <type> <m range> <n range> <k range>
+ *
+ * where type is one of s, d, c, or z, and each range is "x", "min:max", or
+ * "min:max:delta". Since tuned entries are looked up by the nearest power of
+ * two of each dimension, ranges should usually be powers of two.
+ */
+
+using namespace std;
+using namespace tblis;
+
+struct shape_range
+{
+    len_type from, to, delta;
+};
+
+shape_range parse_range(const string & s)
+{
+    len_type mn, mx;
+    len_type delta = 1;
+
+    size_t colon1 = s.find(':');
+    size_t colon2 = s.find(':', colon1 == string::npos ? colon1 : colon1+1);
+
+    if (colon1 == string::npos)
+    {
+        mn = mx = stol(s);
+    }
+    else if (colon2 == string::npos)
+    {
+        mn = stol(s.substr(0, colon1));
+        mx = stol(s.substr(colon1+1));
+    }
+    else
+    {
+        mn = stol(s.substr(0, colon1));
+        mx = stol(s.substr(colon1+1, colon2-colon1-1));
+        delta = stol(s.substr(colon2+1));
+    }
+
+    return {mn, mx, delta};
+}
+
+vector<tuned_thread_config> candidate_configs(const config& cfg, type_t type,
+                                              int nthread)
+{
+    int mr_max = cfg.mr_max_thread._val[type];
+    int nr_max = cfg.nr_max_thread._val[type];
+
+    vector<tuned_thread_config> candidates;
+
+    for (int jc = 1;jc <= nthread;jc++)
+    {
+        if (nthread%jc) continue;
+        for (int ic = 1;ic <= nthread/jc;ic++)
+        {
+            if ((nthread/jc)%ic) continue;
+            for (int jr = 1;jr <= max(1, nr_max);jr++)
+            {
+                if ((nthread/jc/ic)%jr) continue;
+                int ir = nthread/jc/ic/jr;
+                if (ir > max(1, mr_max)) continue;
+
+                tuned_thread_config tc;
+                tc.jc_nt = jc;
+                tc.ic_nt = ic;
+                tc.jr_nt = jr;
+                tc.ir_nt = ir;
+                candidates.push_back(tc);
+            }
+        }
+    }
+
+    return candidates;
+}
+
+void set_thread_env(const tuned_thread_config& tc)
+{
+    setenv("BLIS_JC_NT", to_string(tc.jc_nt).c_str(), 1);
+    setenv("BLIS_IC_NT", to_string(tc.ic_nt).c_str(), 1);
+    setenv("BLIS_JR_NT", to_string(tc.jr_nt).c_str(), 1);
+    setenv("BLIS_IR_NT", to_string(tc.ir_nt).c_str(), 1);
+}
+
+void unset_thread_env()
+{
+    unsetenv("BLIS_JC_NT");
+    unsetenv("BLIS_IC_NT");
+    unsetenv("BLIS_JR_NT");
+    unsetenv("BLIS_IR_NT");
+}
+
+template <typename T>
+double time_gemm(int R, matrix<T>& A, matrix<T>& B, matrix<T>& C)
+{
+    double dt = numeric_limits<double>::max();
+    for (int r = 0;r < R;r++)
+    {
+        double t0 = tic();
+        mult(T(1), A, B, T(0), C);
+        double t1 = tic();
+        dt = min(dt, t1-t0);
+    }
+    return dt;
+}
+
+template <typename T>
+void tune(int R, int nthread, len_type m, len_type n, len_type k)
+{
+    const config& cfg = get_default_config();
+    type_t type = type_tag<T>::value;
+
+    matrix<T> A({m, k}), B({k, n}), C({m, n});
+    for (len_type i = 0;i < m*k;i++) A.data()[i] = random_unit<T>();
+    for (len_type i = 0;i < k*n;i++) B.data()[i] = random_unit<T>();
+
+    /*
+     * The thread configuration is looked up using the shape of the product as
+     * it is actually computed, which is transposed if C is stored the other
+     * way from what the micro-kernel wants.
+     */
+    len_type m_gemm = m, n_gemm = n;
+    if ((cfg.gemm_row_major.value<T>() ? C.stride(0) : C.stride(1)) == 1)
+        swap(m_gemm, n_gemm);
+
+    unset_thread_env();
+    auto current = make_gemm_thread_config<T>(cfg, nthread, m_gemm, n_gemm, k);
+    double t_current = time_gemm(R, A, B, C);
+
+    tuned_thread_config best;
+    double t_best = numeric_limits<double>::max();
+
+    for (auto& tc : candidate_configs(cfg, type, nthread))
+    {
+        set_thread_env(tc);
+        double t = time_gemm(R, A, B, C);
+        if (t < t_best)
+        {
+            t_best = t;
+            best = tc;
+        }
+    }
+
+    unset_thread_env();
+
+    set_tuned_thread_config(cfg.name, type, nthread, m_gemm, n_gemm, k, best);
+
+    double flops = 2.0*m*n*k*(is_complex<T>::value ? 4 : 1);
+    printf("%c %ld %ld %ld: best %d %d %d %d %.3f GFLOPs, "
+           "current %d %d %d %d %.3f GFLOPs\n",
+           "sdcz"[type], (long)m, (long)n, (long)k,
+           best.jc_nt, best.ic_nt, best.jr_nt, best.ir_nt, flops/t_best/1e9,
+           current.jc_nt, current.ic_nt, current.jr_nt, current.ir_nt,
+           flops/t_current/1e9);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    int R = 5;
+    int nthread = tblis_get_num_threads();
+    const char* env_file = getenv("TBLIS_THREAD_TUNING_FILE");
+    string file = (env_file ? env_file : "tblis_threads.tune");
+
+    struct option opts[] = {{"rep", required_argument, NULL, 'r'},
+                            {"threads", required_argument, NULL, 't'},
+                            {"output", required_argument, NULL, 'o'},
+                            {0, 0, 0, 0}};
+
+    int arg;
+    int index;
+    while ((arg = getopt_long(argc, argv, "r:t:o:", opts, &index)) != -1)
+    {
+        istringstream iss;
+        switch (arg)
+        {
+            case 'r':
+                iss.str(optarg);
+                iss >> R;
+                break;
+            case 't':
+                iss.str(optarg);
+                iss >> nthread;
+                break;
+            case 'o':
+                file = optarg;
+                break;
+            case '?':
+                abort();
+                break;
+        }
+    }
+
+    /*
+     * Keep any entries for other shapes, thread counts, or configurations.
+     */
+    load_thread_tuning(file);
+
+    tblis_set_num_threads(nthread);
+
+    cout << "Tuning " << get_default_config().name << " with "
+         << nthread << " threads" << endl;
+
+    string line;
+    while (getline(cin, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+
+        char dt;
+        string m_range, n_range, k_range;
+        istringstream iss(line);
+        iss >> dt >> m_range >> n_range >> k_range;
+
+        if (string("sdcz").find(dt) == string::npos)
+        {
+            cerr << "Unknown datatype: " << dt << endl;
+            exit(1);
+        }
+
+        auto mr = parse_range(m_range);
+        auto nr = parse_range(n_range);
+        auto kr = parse_range(k_range);
+
+        for (len_type m = mr.from;m <= mr.to;m += mr.delta)
+        for (len_type n = nr.from;n <= nr.to;n += nr.delta)
+        for (len_type k = kr.from;k <= kr.to;k += kr.delta)
+        {
+            switch (dt)
+            {
+                case 's': tune<   float>(R, nthread, m, n, k); break;
+                case 'd': tune<  double>(R, nthread, m, n, k); break;
+                case 'c': tune<scomplex>(R, nthread, m, n, k); break;
+                case 'z': tune<dcomplex>(R, nthread, m, n, k); break;
+            }
+        }
+    }
+
+    if (!save_thread_tuning(file))
+    {
+        cerr << "Could not write " << file << endl;
+        exit(1);
+    }
+
+    cout << "Wrote " << file << endl;
+}
@@ -0,0 +1,239 @@
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <tuple>
+
+#include "tblis.h"
+#include "util/time.hpp"
+#include "util/random.hpp"
+#include "configs/configs.hpp"
+
+/*
+ * Tune the gemm cache blocksizes (MC, NC, and KC) of each configuration which
+ * can run on this machine, and write them to a file which the library reads
+ * at startup through TBLIS_BLOCKSIZE_FILE.
+ *
+ * The search is a simple coordinate descent starting from the compiled-in
+ * blocksizes: KC, then MC, then NC are each scaled by a set of factors while
+ * the other two are held fixed, and the fastest value is kept. This is
+ * repeated for the given number of passes. Timings are single-threaded, on
+ * square problems of the given size.
+ */
+
+using namespace std;
+using namespace tblis;
+
+typedef tuple<len_type,len_type,len_type> blocksizes;
+
+template <typename T>
+blocksizes get_blocksizes(const config& cfg)
+{
+    return blocksizes(cfg.gemm_mc.def<T>(),
+                      cfg.gemm_nc.def<T>(),
+                      cfg.gemm_kc.def<T>());
+}
+
+template <typename T>
+double time_gemm(const config& cfg, int R, matrix<T>& A, matrix<T>& B,
+                 matrix<T>& C)
+{
+    tblis_matrix At(A), Bt(B), Ct(C);
+    Ct.scalar = T(0);
+
+    auto tcfg = reinterpret_cast<const tblis_config*>(&cfg);
+
+    double dt = numeric_limits<double>::max();
+    for (int r = 0;r < R;r++)
+    {
+        double t0 = tic();
+        tblis_matrix_mult(tblis_single, tcfg, &At, &Bt, &Ct);
+        double t1 = tic();
+        dt = min(dt, t1-t0);
+    }
+    return dt;
+}
+
+template <typename T>
+blocksizes tune(const config& cfg, int R, int passes, len_type size)
+{
+    type_t type = type_tag<T>::value;
+
+    matrix<T> A({size, size}, 0.0, COLUMN_MAJOR);
+    matrix<T> B({size, size}, 0.0, COLUMN_MAJOR);
+    matrix<T> C({size, size}, 0.0, COLUMN_MAJOR);
+    for (len_type i = 0;i < size*size;i++) A.data()[i] = random_unit<T>();
+    for (len_type i = 0;i < size*size;i++) B.data()[i] = random_unit<T>();
+
+    map<blocksizes,double> timings;
+
+    auto time = [&](const blocksizes& bs)
+    {
+        set_gemm_cache_blocksizes(cfg.name, type, get<0>(bs), get<1>(bs), get<2>(bs));
+        /*
+         * Blocksizes are rounded, so look up what was actually set.
+         */
+        auto actual = get_blocksizes<T>(cfg);
+        auto it = timings.find(actual);
+        if (it != timings.end()) return make_pair(actual, it->second);
+
+        double t = time_gemm(cfg, R, A, B, C);
+        timings[actual] = t;
+        return make_pair(actual, t);
+    };
+
+    const double factors[] = {0.5, 0.75, 1.0, 1.25, 1.5, 2.0};
+
+    auto initial = get_blocksizes<T>(cfg);
+    auto best = time(initial);
+
+    for (int pass = 0;pass < passes;pass++)
+    {
+        for (int dim : {2, 0, 1})
+        {
+            auto start = best.first;
+
+            for (double f : factors)
+            {
+                auto bs = start;
+                switch (dim)
+                {
+                    case 0: get<0>(bs) = get<0>(start)*f; break;
+                    case 1: get<1>(bs) = get<1>(start)*f; break;
+                    case 2: get<2>(bs) = get<2>(start)*f; break;
+                }
+
+                auto cur = time(bs);
+                if (cur.second < best.second) best = cur;
+            }
+        }
+    }
+
+    set_gemm_cache_blocksizes(cfg.name, type, get<0>(best.first),
+                              get<1>(best.first), get<2>(best.first));
+
+    double flops = 2.0*size*size*size*(is_complex<T>::value ? 4 : 1);
+    printf("%s %c: mc %ld nc %ld kc %ld %.3f GFLOPs, "
+           "initial mc %ld nc %ld kc %ld %.3f GFLOPs\n",
+           cfg.name, "sdcz"[type],
+           (long)get<0>(best.first), (long)get<1>(best.first),
+           (long)get<2>(best.first), flops/best.second/1e9,
+           (long)get<0>(initial), (long)get<1>(initial),
+           (long)get<2>(initial), flops/timings[initial]/1e9);
+    fflush(stdout);
+
+    return best.first;
+}
+
+int main(int argc, char** argv)
+{
+    int R = 3;
+    int passes = 1;
+    len_type size = 2000;
+    string types = "sdcz";
+    string config_name;
+    const char* env_file = getenv("TBLIS_BLOCKSIZE_FILE");
+    string file = (env_file ? env_file : "tblis_blocksizes.conf");
+
+    struct option opts[] = {{"rep", required_argument, NULL, 'r'},
+                            {"passes", required_argument, NULL, 'p'},
+                            {"size", required_argument, NULL, 'n'},
+                            {"types", required_argument, NULL, 't'},
+                            {"config", required_argument, NULL, 'c'},
+                            {"output", required_argument, NULL, 'o'},
+                            {0, 0, 0, 0}};
+
+    int arg;
+    int index;
+    while ((arg = getopt_long(argc, argv, "r:p:n:t:c:o:", opts, &index)) != -1)
+    {
+        istringstream iss;
+        switch (arg)
+        {
+            case 'r':
+                iss.str(optarg);
+                iss >> R;
+                break;
+            case 'p':
+                iss.str(optarg);
+                iss >> passes;
+                break;
+            case 'n':
+                iss.str(optarg);
+                iss >> size;
+                break;
+            case 't':
+                types = optarg;
+                break;
+            case 'c':
+                config_name = optarg;
+                break;
+            case 'o':
+                file = optarg;
+                break;
+            case '?':
+                abort();
+                break;
+        }
+    }
+
+    /*
+     * Keep the lines for any configurations and types which aren't tuned now.
+     */
+    map<pair<string,char>,string> lines;
+    {
+        ifstream ifs(file);
+        string line;
+        while (getline(ifs, line))
+        {
+            istringstream iss(line);
+            string name;
+            char type;
+            if (!(iss >> name) || name[0] == '#' || !(iss >> type)) continue;
+            lines[make_pair(name, type)] = line;
+        }
+    }
+
+    for (auto cfg : get_usable_configs())
+    {
+        if (!config_name.empty() && config_name != cfg->name) continue;
+
+        for (char type : types)
+        {
+            blocksizes bs;
+            switch (type)
+            {
+                case 's': bs = tune<   float>(*cfg, R, passes, size); break;
+                case 'd': bs = tune<  double>(*cfg, R, passes, size); break;
+                case 'c': bs = tune<scomplex>(*cfg, R, passes, size); break;
+                case 'z': bs = tune<dcomplex>(*cfg, R, passes, size); break;
+                default:
+                    cerr << "Unknown datatype: " << type << endl;
+                    exit(1);
+            }
+
+            ostringstream oss;
+            oss << cfg->name << ' ' << type << ' ' << get<0>(bs) << ' '
+                << get<1>(bs) << ' ' << get<2>(bs);
+            lines[make_pair(string(cfg->name), type)] = oss.str();
+        }
+    }
+
+    ofstream ofs(file);
+    ofs << "# config type mc nc kc\n";
+    for (auto& line : lines) ofs << line.second << '\n';
+
+    if (!ofs)
+    {
+        cerr << "Could not write " << file << endl;
+        exit(1);
+    }
+
+    cout << "Wrote " << file << endl;
+}